@@ -1,5 +1,6 @@
 ﻿#include "Canvas.h"
 #include "Util.h"
+#include "ThreadPool.h"
 #include <list>
 #include <algorithm>
 
@@ -203,16 +204,25 @@ void Canvas::triangulate(std::vector<float>* vertices)
 {
 	//输出三角面顺时针绕序
 	
+	//paths only touch their own points and triangles, they are split on the thread pool
+	parallel_for(u32(paths.size()), 1, [&](u32 begin, u32 end)
+		{
+			for (u32 i = begin; i < end; i++)
+			{
+				PathState& path = paths[i];
+				if (path.done)
+				{
+					if (path.fill)
+						triangulateFill(path);
+					else
+						triangulateStroke(path);
+				}
+			}
+		});
+
 	for (int i = 0; i < paths.size(); i++)
 	{
 		PathState& path = paths[i];
-		if (path.done)
-		{
-			if (path.fill)
-				triangulateFill(path);
-			else
-				triangulateStroke(path);
-		}
 
 		//顶点添加z和颜色
 		vec4<f32> c = hex2rgba(path.color);
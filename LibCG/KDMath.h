@@ -11,8 +11,12 @@
 #include <cmath>
 #include <iostream>
 
+typedef uint8_t u8;
+typedef uint16_t u16;
 typedef uint32_t u32;
+typedef uint64_t u64;
 typedef int32_t i32;
+typedef int64_t i64;
 typedef float f32;
 typedef double f64;
 
@@ -91,6 +95,12 @@ struct vec2
 		return y;
 	}
 
+	const T& operator[](int i) const
+	{
+		if (i == 0) return x;
+		return y;
+	}
+
 	vec2<T> operator+(vec2<T> v) const
 	{
 		return vec2<T>(x + v.x, y + v.y);
@@ -187,6 +197,13 @@ struct vec3
 		return z;
 	}
 
+	const T& operator[](int i) const
+	{
+		if (i == 0) return x;
+		if (i == 1) return y;
+		return z;
+	}
+
 	vec3<T> operator+(const vec3<T>& v) const
 	{
 		return vec3(x + v.x, y + v.y, z + v.z);
@@ -359,6 +376,14 @@ struct vec4
 		return w;
 	}
 
+	const T& operator[](int i) const
+	{
+		if (i == 0) return x;
+		if (i == 1) return y;
+		if (i == 2) return z;
+		return w;
+	}
+
 	vec4<T> operator+(vec4<T> v) const
 	{
 		return vec4<T>(x + v.x, y + v.y, z + v.z, w + v.w);
@@ -904,6 +929,11 @@ struct ray
 	f32 tMin = 0.0f;
 
 	f32 tMax = F32_INF;
+
+	//ray cone, footprint = coneWidth + coneSpread * t
+	f32 coneWidth = 0.0f;
+
+	f32 coneSpread = 0.0f;
 };
 
 // aabb Declarations
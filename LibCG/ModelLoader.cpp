@@ -1,43 +1,122 @@
 ﻿#include "ModelLoader.h"
 #include <iostream>
+#include "Util.h"
+#include "ThreadPool.h"
+#include <cstring>
+#include <climits>
+#include <algorithm>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "../Deps/tiny_obj_loader.h"
 
 using byte = unsigned char;
 
+//illum 3 and 5 are ray traced reflection, 4, 6, 7 and 9 refraction, PBR roughness or metallic (Pr, Pm) select Disney
+static Material load_material(const tinyobj::material_t& mtl)
+{
+	Material material;
+	material.color = vec3<f32>(mtl.diffuse[0], mtl.diffuse[1], mtl.diffuse[2]);
+	material.emissive = vec3<f32>(mtl.emission[0], mtl.emission[1], mtl.emission[2]);
+	//tinyobj defaults Ni to 1, no refraction at all
+	if (mtl.ior > 1.0f)
+		material.ior = mtl.ior;
+
+	switch (mtl.illum)
+	{
+	case 3:
+	case 5:
+	{
+		material.type = MaterialType::Mirror;
+		vec3<f32> specular(mtl.specular[0], mtl.specular[1], mtl.specular[2]);
+		material.color = luminance(specular) > 0.0f ? specular : vec3<f32>(1.0f);
+		break;
+	}
+	case 4:
+	case 6:
+	case 7:
+	case 9:
+	{
+		material.type = MaterialType::Glass;
+		vec3<f32> filter(mtl.transmittance[0], mtl.transmittance[1], mtl.transmittance[2]);
+		material.color = luminance(filter) > 0.0f ? filter : vec3<f32>(1.0f);
+		break;
+	}
+	default:
+		if (mtl.roughness > 0.0f || mtl.metallic > 0.0f)
+		{
+			material.type = MaterialType::Disney;
+			material.roughness = mtl.roughness;
+			material.metallic = mtl.metallic;
+		}
+		break;
+	}
+	return material;
+}
+
 bool ObjLoader::loadPrimitive(const char* filename, std::vector<Primitive*>& outPrimitives)
 {
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
 
+	//mtllib paths are relative to the obj
+	std::string basedir(filename);
+	size_t slash = basedir.find_last_of("/\\");
+	basedir = slash == std::string::npos ? std::string() : basedir.substr(0, slash + 1);
+
 	std::string err;
-	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filename);
+	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filename, basedir.empty() ? NULL : basedir.c_str());
 	if (!ret)
 		return false;
 
+	std::vector<Material> loadedMaterials;
+	loadedMaterials.reserve(materials.size());
+	for (auto& mtl : materials)
+		loadedMaterials.push_back(load_material(mtl));
+
+	//faces are built on the thread pool into their own slots, the order stays the file's
+	const u32 FACES_PER_TASK = 1024;
+	std::vector<size_t> indexOffsets;
 	for (size_t i = 0; i < shapes.size(); i++)
 	{
+		const tinyobj::mesh_t& mesh = shapes[i].mesh;
+		size_t faceCount = mesh.num_face_vertices.size();
+		indexOffsets.resize(faceCount);
 		size_t index_offset = 0;
-		for (size_t f = 0; f < shapes[i].mesh.num_face_vertices.size(); f++)
+		for (size_t f = 0; f < faceCount; f++)
 		{
-			PrimitiveTriangle* primTriangle = new PrimitiveTriangle();
+			indexOffsets[f] = index_offset;
+			index_offset += mesh.num_face_vertices[f];
+		}
 
-			size_t fnum = shapes[i].mesh.num_face_vertices[f];
-			for (size_t v = 0; v < fnum; v++)
+		size_t first = outPrimitives.size();
+		outPrimitives.resize(first + faceCount);
+		parallel_for(u32(faceCount), FACES_PER_TASK, [&](u32 begin, u32 end)
 			{
-				tinyobj::index_t idx = shapes[i].mesh.indices[index_offset + v];
-				primTriangle->vertex[v] = vec3<f32>(
-					attrib.vertices[3 * idx.vertex_index],
-					attrib.vertices[3 * idx.vertex_index + 1],
-					attrib.vertices[3 * idx.vertex_index + 2]);
-			}
-			index_offset += fnum;
+				for (size_t f = begin; f < end; f++)
+				{
+					PrimitiveTriangle* primTriangle = new PrimitiveTriangle();
 
-			primTriangle->updateAabb();
-			outPrimitives.push_back(primTriangle);
-		}
+					size_t fnum = mesh.num_face_vertices[f];
+					for (size_t v = 0; v < fnum; v++)
+					{
+						tinyobj::index_t idx = mesh.indices[indexOffsets[f] + v];
+						primTriangle->vertex[v] = vec3<f32>(
+							attrib.vertices[3 * idx.vertex_index],
+							attrib.vertices[3 * idx.vertex_index + 1],
+							attrib.vertices[3 * idx.vertex_index + 2]);
+					}
+
+					int materialId = f < mesh.material_ids.size() ? mesh.material_ids[f] : -1;
+					if (materialId >= 0 && materialId < (int)loadedMaterials.size())
+					{
+						primTriangle->material = loadedMaterials[materialId];
+					}
+
+					primTriangle->updateAabb();
+					outPrimitives[first + f] = primTriangle;
+				}
+			});
 	}
 
 	return true;
@@ -50,119 +129,258 @@ bool VoxLoader::loadPrimitive(const char* filename, std::vector<Primitive*>& out
 
 	if (!succ)	return false;
 
-	for (auto& voxelChunk : voxelChunks)
+	std::vector<VoxelBox> voxelBoxes;
+	if (mergeBoxes)
 	{
-		vec3<f32> positon(voxelChunk.x, voxelChunk.y, voxelChunk.z);
-		unsigned color = palette[voxelChunk.index - 1];
-		float a = ((color >> 24) & 0xff) / 255.0f;
-		float b = ((color >> 16) & 0xff) / 255.0f;
-		float g = ((color >> 8) & 0xff) / 255.0f;
-		float r = ((color) & 0xff) / 255.0f;
-
-		vec3<f32> offset(dimX * 0.5f - 0.5f, 0.0f, dimZ * -0.5f + 0.5f);
-		vec3<f32> pmin = positon - vec3<f32>(0.5f) + offset; //x轴翻转
-		vec3<f32> pmax = positon + vec3<f32>(0.5f) + offset;
-
-		PrimitiveAabox* primAabox = new PrimitiveAabox();
-		primAabox->aabb.min = pmin;
-		primAabox->aabb.max = pmax;
-		primAabox->material.color = vec3<f32>(r, g, b);
-		outPrimitives.push_back(primAabox);
+		mergeVoxelBoxes(voxelChunks, voxelBoxes);
+	}
+	else
+	{
+		voxelBoxes.reserve(voxelChunks.size());
+		for (auto& voxelChunk : voxelChunks)
+		{
+			VoxelBox voxelBox;
+			voxelBox.min[0] = voxelBox.max[0] = voxelChunk.x;
+			voxelBox.min[1] = voxelBox.max[1] = voxelChunk.y;
+			voxelBox.min[2] = voxelBox.max[2] = voxelChunk.z;
+			voxelBox.index = voxelChunk.index;
+			voxelBoxes.push_back(voxelBox);
+		}
 	}
 
+	const u32 BOXES_PER_TASK = 1024;
+	size_t first = outPrimitives.size();
+	outPrimitives.resize(first + voxelBoxes.size());
+	parallel_for(u32(voxelBoxes.size()), BOXES_PER_TASK, [&](u32 begin, u32 end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const VoxelBox& voxelBox = voxelBoxes[i];
+				unsigned color = palette[voxelBox.index - 1];
+				float a = ((color >> 24) & 0xff) / 255.0f;
+				float b = ((color >> 16) & 0xff) / 255.0f;
+				float g = ((color >> 8) & 0xff) / 255.0f;
+				float r = ((color) & 0xff) / 255.0f;
+
+				vec3<f32> offset(dimX * 0.5f - 0.5f, 0.0f, dimZ * -0.5f + 0.5f);
+				vec3<f32> pmin = vec3<f32>(voxelBox.min[0], voxelBox.min[1], voxelBox.min[2]) - vec3<f32>(0.5f) + offset; //x轴翻转
+				vec3<f32> pmax = vec3<f32>(voxelBox.max[0], voxelBox.max[1], voxelBox.max[2]) + vec3<f32>(0.5f) + offset;
+
+				PrimitiveAabox* primAabox = new PrimitiveAabox();
+				primAabox->aabb.min = pmin;
+				primAabox->aabb.max = pmax;
+				primAabox->material.color = vec3<f32>(r, g, b);
+				outPrimitives[first + i] = primAabox;
+			}
+		});
+
 	return voxelChunks.size() > 0;
 }
 
+void VoxLoader::mergeVoxelBoxes(const std::vector<VoxelChunk>& voxelChunks, std::vector<VoxelBox>& outBoxes)
+{
+	if (voxelChunks.empty())
+		return;
+
+	short bmin[3] = { SHRT_MAX, SHRT_MAX, SHRT_MAX };
+	short bmax[3] = { SHRT_MIN, SHRT_MIN, SHRT_MIN };
+	for (auto& voxelChunk : voxelChunks)
+	{
+		short p[3] = { voxelChunk.x, voxelChunk.y, voxelChunk.z };
+		for (int i = 0; i < 3; i++)
+		{
+			bmin[i] = std::min(bmin[i], p[i]);
+			bmax[i] = std::max(bmax[i], p[i]);
+		}
+	}
+
+	//dense grid of palette index, 0 = empty
+	int sx = bmax[0] - bmin[0] + 1;
+	int sy = bmax[1] - bmin[1] + 1;
+	int sz = bmax[2] - bmin[2] + 1;
+	std::vector<byte> grid((size_t)sx * sy * sz, 0);
+	auto cell = [&](int x, int y, int z) -> byte& { return grid[((size_t)z * sy + y) * sx + x]; };
+	for (auto& voxelChunk : voxelChunks)
+		cell(voxelChunk.x - bmin[0], voxelChunk.y - bmin[1], voxelChunk.z - bmin[2]) = (byte)voxelChunk.index;
+
+	//greedy: grow along x, then whole rows along y, then whole slabs along z
+	for (int z = 0; z < sz; z++)
+	{
+		for (int y = 0; y < sy; y++)
+		{
+			for (int x = 0; x < sx; x++)
+			{
+				byte index = cell(x, y, z);
+				if (index == 0)
+					continue;
+
+				int w = 1;
+				while (x + w < sx && cell(x + w, y, z) == index)
+					w++;
+
+				int h = 1;
+				while (y + h < sy)
+				{
+					bool same = true;
+					for (int i = 0; i < w && same; i++)
+						same = cell(x + i, y + h, z) == index;
+					if (!same) break;
+					h++;
+				}
+
+				int d = 1;
+				while (z + d < sz)
+				{
+					bool same = true;
+					for (int j = 0; j < h && same; j++)
+						for (int i = 0; i < w && same; i++)
+							same = cell(x + i, y + j, z + d) == index;
+					if (!same) break;
+					d++;
+				}
+
+				for (int k = 0; k < d; k++)
+					for (int j = 0; j < h; j++)
+						for (int i = 0; i < w; i++)
+							cell(x + i, y + j, z + k) = 0;
+
+				VoxelBox voxelBox;
+				voxelBox.min[0] = short(bmin[0] + x);
+				voxelBox.min[1] = short(bmin[1] + y);
+				voxelBox.min[2] = short(bmin[2] + z);
+				voxelBox.max[0] = short(bmin[0] + x + w - 1);
+				voxelBox.max[1] = short(bmin[1] + y + h - 1);
+				voxelBox.max[2] = short(bmin[2] + z + d - 1);
+				voxelBox.index = index;
+				outBoxes.push_back(voxelBox);
+			}
+		}
+	}
+}
+
+bool VoxLoader::loadVoxelTree(const char* filename, VoxelTree& outTree)
+{
+	std::vector<VoxelChunk> voxelChunks;
+	bool succ = loadInternal(filename, voxelChunks);
+
+	if (!succ || voxelChunks.empty())	return false;
+
+	//grid coordinates start at 0, x flipped back like loadPrimitive
+	std::vector<Voxel> voxels;
+	voxels.reserve(voxelChunks.size());
+	for (auto& voxelChunk : voxelChunks)
+	{
+		Voxel voxel;
+		voxel.x = dimX - 1 + voxelChunk.x;
+		voxel.y = voxelChunk.y;
+		voxel.z = voxelChunk.z;
+		voxel.index = (u8)voxelChunk.index;
+		voxels.push_back(voxel);
+	}
+
+	outTree.origin = vec3<f32>(dimX * -0.5f, -0.5f, dimZ * -0.5f);
+	memcpy(outTree.palette, palette, sizeof(palette));
+	outTree.build(voxels);
+	return true;
+}
+
+static inline int read_int(const byte* p)
+{
+	int v;
+	memcpy(&v, p, sizeof(int));
+	return v;
+}
+
 bool VoxLoader::loadInternal(const char* filename, std::vector<VoxelChunk>& voxelChunks)
 {
-	FILE* file = nullptr;
-	fopen_s(&file, filename, "rb");
-	if (!file)	return false;
+	MappedFile file;
+	if (!file.open(filename))	return false;
 
-	//文件大小
-	fseek(file, 0, SEEK_END);
-	long fileSize = ftell(file);
-	fseek(file, 0, SEEK_SET);
+	const byte* data = file.data;
+	size_t fileSize = file.size;
 
 	//https://github.com/ephtracy/voxel-model/blob/master/MagicaVoxel-file-format-vox.txt
-	//"VOX "
-	char fileType[5];
-	fileType[4] = '\0';
-	fread(fileType, sizeof(char), 4, file);
-	if (strcmp(fileType, "VOX ") != 0)
+	//"VOX " + version
+	if (fileSize < 8 || memcmp(data, "VOX ", 4) != 0)
 	{
 		std::cerr << "error file format " << std::endl;
-		fclose(file);
 		return false;
 	}
 
-	//version
-	int version;
-	fread(&version, sizeof(int), 1, file);
-
-	while (ftell(file) < fileSize)
+	//chunk header: id, num_bytes, num_child_bytes
+	//children follow the content directly, so MAIN is walked like a flat list
+	auto walkChunks = [&](auto&& visit) -> bool
 	{
-		//chunk
-		char chunkID[5];
-		chunkID[4] = '\0';
-		int num_bytes;
-		int num_child_bytes;
-
-		fread(chunkID, sizeof(char), 4, file);
-		fread(&num_bytes, sizeof(int), 1, file);
-		fread(&num_child_bytes, sizeof(int), 1, file);
-
-		if (strcmp(chunkID, "PACK") == 0)
+		size_t offset = 8;
+		while (offset + 12 <= fileSize)
 		{
-			int num_models;
-			fread(&num_models, sizeof(int), 1, file);
-			//std::cout << "num_models:" << num_models << std::endl;
+			const byte* chunk = data + offset;
+			int num_bytes = read_int(chunk + 4);
+			if (num_bytes < 0 || offset + 12 + (size_t)num_bytes > fileSize)
+			{
+				std::cerr << "error file format " << std::endl;
+				return false;
+			}
+			if (!visit(chunk, chunk + 12, (size_t)num_bytes))
+				return false;
+			offset += 12 + (size_t)num_bytes;
 		}
-		else if (strcmp(chunkID, "SIZE") == 0)
+		return true;
+	};
+
+	//first pass: count voxels so the output is allocated once
+	size_t totalVoxels = 0;
+	bool succ = walkChunks([&](const byte* chunk, const byte* content, size_t num_bytes)
 		{
-			int dims[3];
-			fread(dims, sizeof(int), 3, file);
-			dimX = dims[0];
-			dimY = dims[2];
-			dimZ = dims[1];
-			//std::cout << "dims:" << dimX << ", " << dimY << ", " << dimZ << std::endl;
-		}
-		else if (strcmp(chunkID, "XYZI") == 0)
+			if (memcmp(chunk, "XYZI", 4) == 0 && num_bytes >= 4)
+				totalVoxels += (size_t)std::max(read_int(content), 0);
+			return true;
+		});
+	if (!succ)	return false;
+
+	size_t count = voxelChunks.size();
+	voxelChunks.resize(count + totalVoxels);
+
+	succ = walkChunks([&](const byte* chunk, const byte* content, size_t num_bytes)
 		{
-			int numVoxels;
-			fread(&numVoxels, sizeof(int), 1, file);
-			voxelChunks.reserve(numVoxels);
-			for (int i = 0; i < numVoxels; i++)
+			if (memcmp(chunk, "PACK", 4) == 0)
 			{
-				byte voxel[4];
-				fread(voxel, sizeof(byte), 4, file);
-
-				if (voxel[3] < 0 || voxel[3] > 255)
+				//int num_models = read_int(content);
+			}
+			else if (memcmp(chunk, "SIZE", 4) == 0 && num_bytes >= 12)
+			{
+				dimX = read_int(content);
+				dimY = read_int(content + 8);
+				dimZ = read_int(content + 4);
+			}
+			else if (memcmp(chunk, "XYZI", 4) == 0 && num_bytes >= 4)
+			{
+				int numVoxels = read_int(content);
+				if (numVoxels < 0 || 4 + (size_t)numVoxels * 4 > num_bytes)
 				{
-					//std::cerr << "error file format " << std::endl;
-					fclose(file);
+					std::cerr << "error file format " << std::endl;
 					return false;
 				}
 
-				VoxelChunk voxelChunk;
-				voxelChunk.x = -voxel[0];
-				voxelChunk.y = voxel[2];
-				voxelChunk.z = voxel[1];
-				voxelChunk.index = voxel[3];
-				voxelChunks.push_back(voxelChunk);
+				//decode the x, y, z, i records in place
+				const byte* voxel = content + 4;
+				VoxelChunk* out = voxelChunks.data() + count;
+				for (int i = 0; i < numVoxels; i++, voxel += 4)
+				{
+					out[i].x = -voxel[0];
+					out[i].y = voxel[2];
+					out[i].z = voxel[1];
+					out[i].index = voxel[3];
+				}
+				count += numVoxels;
 			}
-		}
-		else if (strcmp(chunkID, "RGBA") == 0)
-		{
-			fread(palette, sizeof(int), 256, file);
-		}
-		else
-		{
-			fseek(file, num_bytes, SEEK_CUR);
-			//std::cout << "chunkID:" << chunkID << std::endl;
-		}
-	}
+			else if (memcmp(chunk, "RGBA", 4) == 0 && num_bytes >= sizeof(palette))
+			{
+				memcpy(palette, content, sizeof(palette));
+			}
+			return true;
+		});
 
-	fclose(file);
-	return true;
+	voxelChunks.resize(count);
+	return succ;
 }
@@ -13,8 +13,13 @@ public:
 class VoxLoader
 {
 public:
+	//merge same palette voxels into maximal boxes before BVH build
+	bool mergeBoxes = true;
+
 	bool loadPrimitive(const char* filename, std::vector<Primitive*>& outPrimitives);
 
+	bool loadVoxelTree(const char* filename, VoxelTree& outTree);
+
 private:
 	struct VoxelChunk
 	{
@@ -24,6 +29,14 @@ private:
 		short index;
 	};
 
+	//inclusive voxel range
+	struct VoxelBox
+	{
+		short min[3];
+		short max[3];
+		short index;
+	};
+
 	int dimX = 0;
 	int dimY = 0;
 	int dimZ = 0;
@@ -49,4 +62,6 @@ private:
 	};
 
 	bool loadInternal(const char* filename, std::vector<VoxelChunk>& voxelChunks);
+
+	void mergeVoxelBoxes(const std::vector<VoxelChunk>& voxelChunks, std::vector<VoxelBox>& outBoxes);
 };
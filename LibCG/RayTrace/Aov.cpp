@@ -0,0 +1,51 @@
+#include "Aov.h"
+
+u32 AovBuffers::channels(Aov aov)
+{
+	switch (aov)
+	{
+	case Aov::Beauty:
+	case Aov::Albedo:
+	case Aov::Normal:
+	case Aov::Barycentric:
+		return 3;
+	default:
+		return 1;
+	}
+}
+
+void AovBuffers::resize(i32 width, i32 height, u32 mask)
+{
+	this->width = width;
+	this->height = height;
+	this->mask = mask;
+	for (u32 i = 0; i < u32(Aov::Count); i++)
+	{
+		if (mask & (1u << i))
+			planes[i].resize(size_t(width) * height * channels(Aov(i)));
+		else
+			std::vector<f32>().swap(planes[i]);
+	}
+}
+
+void AovBuffers::set(Aov aov, size_t pixel, const vec3<f32>& value)
+{
+	if (!has(aov))
+		return;
+
+	u32 n = channels(aov);
+	f32* p = planes[u32(aov)].data() + pixel * n;
+	for (u32 c = 0; c < n; c++)
+		p[c] = value[c];
+}
+
+void AovBuffers::set(Aov aov, size_t pixel, f32 value)
+{
+	if (!has(aov))
+		return;
+
+	u32 n = channels(aov);
+	f32* p = planes[u32(aov)].data() + pixel * n;
+	for (u32 c = 0; c < n; c++)
+		p[c] = value;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include "../KDMath.h"
+
+enum struct Aov
+{
+	Beauty,
+	Albedo,
+	Normal,
+	//distance along the camera front axis, 0 where nothing was hit
+	Depth,
+	//Primitive::id under the first sample, -1 for background
+	PrimitiveId,
+	SampleCount,
+	Barycentric,
+	//luminance variance of the beauty mean, 0 under two samples
+	Variance,
+	//BVH nodes and primitive tests per sample, 0 without RAYTRACE_STATS
+	Cost,
+	Count
+};
+
+inline u32 aov_bit(Aov aov)
+{
+	return 1u << u32(aov);
+}
+
+/**
+* Float planes of one render, row-major like the u32 output.
+* Beauty, Albedo, Normal and Barycentric hold 3 floats per pixel, the others 1.
+*/
+struct AovBuffers
+{
+	i32 width = 0;
+	i32 height = 0;
+	//aov_bit of each allocated plane
+	u32 mask = 0;
+	std::vector<f32> planes[u32(Aov::Count)];
+
+	static u32 channels(Aov aov);
+
+	//allocates the planes in mask and frees the others
+	void resize(i32 width, i32 height, u32 mask);
+
+	bool has(Aov aov) const { return (mask & aov_bit(aov)) != 0; }
+
+	f32* plane(Aov aov) { return has(aov) ? planes[u32(aov)].data() : nullptr; }
+	const f32* plane(Aov aov) const { return has(aov) ? planes[u32(aov)].data() : nullptr; }
+
+	void set(Aov aov, size_t pixel, const vec3<f32>& value);
+	void set(Aov aov, size_t pixel, f32 value);
+};
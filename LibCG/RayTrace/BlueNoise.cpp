@@ -0,0 +1,70 @@
+#include "BlueNoise.h"
+
+//generated by Tools/gen_blue_noise.py, void and cluster 64x64, sigma 1.5
+const u16 BLUE_NOISE_TILE[BLUE_NOISE_SIZE * BLUE_NOISE_SIZE] =
+{
+	3928, 2080, 2696, 1173, 3425, 1530, 125, 1777, 714, 2842, 2333, 3536, 2732, 3785, 2067, 1389, 2994, 1102, 1728, 3082, 1412, 2853, 3662, 143, 1245, 677, 3136, 1542, 1259, 3250, 2599, 2119, 3933, 3024, 1032, 1611, 3889, 305, 3437, 2127, 2761, 873, 1411, 2885, 1734, 3492, 3110, 237, 2116, 2938, 149, 3325, 2681, 2120, 3106, 3984, 670, 1151, 3848, 113, 2822, 2166, 3649, 3072,
+	320, 1601, 656, 2909, 306, 4063, 2653, 3019, 3706, 1042, 251, 1509, 826, 3233, 2395, 608, 3938, 2540, 800, 2238, 4093, 317, 1591, 3223, 3822, 1953, 3473, 249, 2340, 725, 3726, 1808, 101, 1448, 3567, 2262, 1887, 2480, 1238, 4029, 30, 2366, 3190, 309, 3713, 917, 2254, 3779, 1130, 788, 3946, 1687, 1347, 867, 47, 1557, 2767, 318, 2346, 3513, 985, 580, 1649, 876,
+	2519, 3512, 2253, 3685, 1949, 890, 2208, 444, 1402, 2088, 3865, 3116, 1907, 36, 1613, 3387, 200, 1997, 3605, 422, 1075, 3371, 2114, 951, 2582, 377, 2738, 4076, 1744, 3013, 428, 1053, 2919, 2509, 662, 419, 3122, 945, 2932, 693, 1574, 3775, 1095, 2081, 2606, 1334, 545, 2799, 1849, 3213, 2273, 443, 2887, 3813, 2415, 3410, 2022, 3125, 1697, 1344, 2629, 4064, 1991, 2881,
+	3164, 1080, 369, 1427, 3117, 1218, 3592, 1708, 2557, 3373, 572, 2443, 1164, 4065, 2905, 1066, 2669, 1320, 3225, 2743, 1832, 2420, 618, 3062, 1368, 1698, 639, 1111, 2084, 3596, 1393, 2247, 3340, 1713, 4083, 1315, 3462, 136, 1793, 3297, 2666, 1894, 576, 3370, 180, 3866, 1676, 3417, 29, 1484, 2627, 1068, 3449, 1757, 555, 1229, 954, 3935, 701, 3226, 412, 3360, 1, 1354,
+	551, 1846, 3988, 2632, 51, 2400, 668, 3205, 110, 916, 1745, 2976, 382, 2025, 771, 2189, 3837, 307, 1593, 738, 3765, 1289, 3498, 176, 3944, 2372, 3319, 2902, 28, 818, 2718, 3855, 220, 851, 2825, 2105, 2656, 3736, 2294, 1330, 271, 3556, 2442, 1543, 2829, 1983, 1038, 2332, 4009, 590, 3692, 2013, 308, 2301, 2989, 3642, 2678, 404, 2518, 2159, 1778, 1207, 2419, 3843,
+	3402, 2361, 833, 3291, 1725, 3801, 2897, 1352, 3660, 2691, 3920, 1338, 3420, 2618, 3588, 1440, 564, 3456, 1962, 3034, 27, 2624, 1763, 2840, 2068, 852, 3656, 1433, 2538, 3287, 1648, 605, 2012, 3514, 1081, 343, 1528, 591, 1020, 3934, 3055, 869, 1247, 4066, 739, 3146, 381, 2701, 872, 2996, 1256, 3248, 925, 4094, 1375, 182, 1927, 1580, 3527, 921, 3780, 2798, 797, 2108,
+	145, 1478, 2771, 500, 2142, 982, 360, 1856, 2180, 1112, 212, 2270, 696, 1639, 158, 3144, 2379, 2797, 1115, 2177, 4016, 1000, 535, 3730, 1185, 281, 1943, 505, 3968, 1152, 2338, 3040, 1280, 2473, 3091, 3816, 1906, 3359, 2585, 2112, 512, 1966, 2925, 66, 2241, 3616, 1363, 3353, 2082, 1614, 2425, 99, 2786, 1637, 681, 2213, 3351, 2838, 82, 1450, 3075, 278, 3587, 1623,
+	3007, 3665, 1137, 3858, 1400, 3486, 2758, 3952, 748, 3445, 3118, 1897, 3789, 2933, 1018, 3995, 1752, 791, 3634, 418, 1449, 3357, 2334, 1514, 3222, 2486, 2962, 1599, 2157, 191, 3566, 407, 3994, 1740, 44, 2264, 808, 2908, 188, 1467, 3636, 2503, 3335, 1722, 1056, 2576, 1834, 164, 3568, 474, 3929, 1918, 3503, 2484, 3045, 3718, 836, 1197, 4031, 2322, 659, 1977, 1149, 2583,
+	943, 2077, 273, 2945, 2498, 199, 1629, 2412, 483, 1536, 2547, 328, 1228, 2466, 503, 2104, 1308, 109, 3211, 2502, 2893, 1926, 211, 2731, 678, 3927, 1037, 3510, 782, 2815, 1884, 992, 2639, 657, 1454, 3455, 1227, 4034, 1742, 3192, 1003, 298, 1383, 3722, 478, 3949, 708, 2921, 1172, 2647, 798, 1437, 514, 1148, 234, 1765, 2584, 509, 3174, 1787, 2697, 3888, 3268, 575,
+	4035, 3179, 1533, 1895, 646, 3159, 1159, 3327, 2042, 2957, 4049, 810, 3619, 1733, 3444, 3092, 2733, 3878, 1824, 1209, 606, 3844, 937, 3538, 2055, 1691, 90, 3127, 2422, 3859, 1501, 3303, 2138, 3759, 3153, 2730, 460, 2403, 716, 2693, 3882, 1868, 765, 2809, 2057, 3095, 1567, 2336, 3720, 2031, 3300, 2869, 3752, 2132, 3221, 3948, 1434, 2083, 3559, 949, 330, 1314, 2266, 1719,
+	411, 2310, 816, 3541, 3982, 2209, 781, 3824, 78, 981, 1423, 2251, 2845, 20, 1414, 834, 322, 2249, 908, 3677, 2384, 1668, 3028, 1337, 394, 3429, 2261, 1418, 534, 1179, 267, 2918, 846, 173, 1982, 997, 1841, 3674, 1358, 61, 2265, 3008, 3483, 2408, 1198, 119, 3459, 936, 236, 1644, 401, 1036, 2343, 1604, 884, 450, 2915, 108, 2451, 1626, 2953, 3621, 14, 2757,
+	1333, 3414, 2672, 1188, 130, 1730, 2844, 1336, 2595, 3472, 1865, 466, 3306, 1998, 3972, 2392, 3546, 1518, 3059, 357, 3419, 146, 2168, 4059, 2517, 827, 2774, 3747, 2000, 3408, 2504, 1660, 3581, 1327, 2494, 3905, 349, 3074, 2026, 3560, 1157, 521, 1493, 314, 3863, 1924, 2570, 1357, 4028, 3111, 2530, 3846, 26, 3489, 2668, 1882, 3308, 1220, 3850, 727, 3363, 1889, 1093, 3762,
+	651, 1933, 323, 2983, 2429, 3396, 477, 1986, 3090, 321, 3793, 2483, 1144, 631, 2686, 1021, 1904, 570, 2640, 2056, 1421, 2719, 1116, 615, 3254, 1854, 1074, 214, 3054, 773, 4047, 470, 2195, 3018, 607, 3338, 1595, 2793, 907, 3234, 1721, 3989, 2175, 2727, 903, 3183, 598, 2827, 2196, 750, 1852, 1409, 2992, 684, 1291, 2282, 3653, 583, 2794, 1391, 2386, 452, 2200, 3101,
+	2587, 3956, 1663, 3597, 1417, 911, 3696, 2390, 1034, 1684, 777, 2937, 3579, 1616, 3102, 238, 3317, 3737, 1163, 3978, 756, 2993, 3693, 1588, 35, 2896, 3899, 1630, 2365, 1273, 1872, 2790, 957, 3825, 1813, 1231, 187, 2454, 625, 2319, 226, 2852, 742, 3381, 1751, 3672, 1586, 362, 3617, 1193, 3362, 508, 2014, 4088, 2832, 179, 977, 1747, 2141, 153, 4089, 2876, 855, 1504,
+	137, 2272, 998, 617, 2087, 3150, 1581, 250, 3881, 3279, 2320, 1462, 172, 2146, 3820, 1276, 2506, 1689, 58, 3186, 1810, 423, 2311, 1973, 3558, 1303, 2174, 372, 3245, 2649, 248, 3480, 1444, 19, 2634, 2158, 4084, 3393, 1424, 3807, 1060, 3633, 1361, 2072, 13, 1139, 2401, 2958, 1939, 100, 2674, 3655, 2426, 1052, 1695, 3120, 3912, 2571, 3508, 3081, 1161, 1766, 3638, 3347,
+	1243, 3170, 3770, 2657, 85, 4077, 720, 2814, 1263, 1942, 550, 4024, 976, 2818, 507, 1955, 799, 2948, 2257, 948, 2533, 3892, 1012, 3206, 731, 2590, 940, 3464, 660, 3741, 1071, 2271, 3094, 3697, 823, 2914, 1039, 457, 1970, 3002, 1805, 2424, 380, 2626, 4067, 3080, 831, 3891, 1435, 3093, 906, 1631, 282, 3275, 479, 2111, 1452, 397, 863, 1605, 593, 2636, 291, 2039,
+	2863, 510, 1871, 1310, 2970, 2232, 1819, 2489, 3569, 41, 3001, 2563, 1774, 3475, 2377, 3139, 4095, 440, 3614, 1559, 3339, 157, 1431, 2433, 253, 4012, 3009, 1984, 1377, 1770, 2942, 538, 1659, 2045, 338, 3242, 1633, 3670, 2714, 67, 821, 3454, 3199, 647, 1472, 1827, 224, 2130, 574, 3478, 2275, 3818, 1278, 2756, 3714, 769, 3441, 2974, 2027, 3798, 3262, 2219, 3919, 786,
+	1654, 2347, 3394, 391, 3647, 1013, 462, 3108, 845, 2161, 1180, 3707, 728, 1359, 88, 1061, 1603, 2707, 1300, 616, 2858, 2062, 3639, 2823, 1821, 1564, 463, 2335, 3872, 134, 2487, 4019, 919, 3358, 1279, 2344, 686, 2477, 1206, 3962, 1625, 2193, 1170, 2874, 3507, 2455, 3708, 2782, 1058, 2554, 170, 2034, 641, 1782, 2316, 1166, 2513, 46, 1343, 2440, 352, 1009, 1415, 3474,
+	34, 4007, 886, 1554, 2579, 1715, 3385, 1369, 3963, 1645, 3352, 367, 2063, 3219, 3809, 1862, 3453, 204, 2198, 3845, 1736, 475, 1201, 626, 3769, 3249, 1158, 2776, 795, 3364, 1150, 2126, 197, 2577, 3861, 1826, 3516, 269, 2035, 3049, 584, 3644, 168, 1915, 912, 442, 1269, 3312, 1789, 3985, 1491, 2961, 3348, 3954, 186, 2892, 1737, 4023, 930, 3524, 2837, 1934, 3041, 2499,
+	1160, 2765, 2110, 3210, 166, 3907, 2303, 265, 2705, 579, 2428, 2924, 1535, 2643, 601, 2913, 2444, 794, 3169, 984, 3509, 2380, 3097, 2145, 958, 2511, 74, 3643, 1522, 1881, 3085, 3574, 1407, 2846, 557, 1073, 2890, 1492, 3350, 956, 2317, 2779, 1349, 3782, 2170, 3103, 1669, 275, 792, 3129, 519, 1122, 2207, 898, 1480, 3570, 543, 3126, 2178, 683, 1672, 203, 3742, 649,
+	1905, 3700, 571, 1265, 2859, 718, 1127, 3005, 1883, 3758, 1092, 210, 3987, 888, 2176, 299, 1341, 3909, 1936, 2665, 33, 1401, 4054, 266, 3490, 1466, 1976, 3149, 556, 2706, 290, 694, 1781, 3733, 2221, 83, 4027, 2522, 399, 3728, 1549, 416, 3162, 2556, 674, 3973, 2659, 2296, 3743, 1971, 2457, 3599, 351, 2652, 3202, 1988, 1090, 2612, 1539, 3244, 3936, 2345, 1319, 3313,
+	361, 1606, 3479, 2469, 1836, 3768, 2093, 3549, 780, 1436, 2201, 3515, 1830, 1271, 3375, 3673, 1711, 2998, 358, 1547, 3390, 772, 2891, 1896, 2694, 734, 3979, 2263, 1002, 3781, 2156, 2510, 941, 3281, 1597, 3134, 1944, 848, 1312, 2685, 1994, 4048, 1022, 1731, 18, 1457, 944, 3470, 1210, 103, 2813, 1403, 1851, 3877, 732, 2397, 329, 3766, 106, 1178, 487, 2741, 866, 2194,
+	2604, 2995, 93, 963, 3302, 417, 1386, 57, 2623, 3240, 409, 3011, 2574, 2, 2778, 1019, 628, 2256, 1085, 3740, 2041, 2453, 1103, 1556, 448, 3333, 1253, 245, 2978, 1641, 1260, 3932, 2739, 373, 1240, 679, 3632, 2291, 3089, 95, 3372, 724, 2393, 3585, 3285, 2884, 1902, 559, 2975, 1638, 4053, 968, 2990, 25, 1251, 3658, 3077, 1840, 2867, 2096, 3530, 1749, 3184, 3901,
+	1392, 1079, 4068, 2154, 1532, 2690, 3140, 2374, 1723, 4078, 952, 1575, 697, 3904, 1880, 2398, 3270, 4033, 2631, 548, 3204, 181, 3542, 3908, 3006, 2352, 1705, 2630, 3555, 498, 3143, 24, 1929, 3525, 2405, 2808, 1701, 454, 3914, 1754, 1165, 2868, 243, 2092, 1138, 347, 3814, 2160, 3295, 406, 2313, 648, 3330, 2485, 2103, 1656, 502, 1376, 4060, 897, 2460, 1461, 156, 673,
+	3564, 1815, 2421, 627, 3663, 859, 3916, 1154, 621, 2805, 2051, 3366, 2298, 1422, 3088, 429, 1502, 92, 1806, 1288, 2820, 1664, 658, 2135, 932, 53, 3833, 1082, 2032, 840, 2360, 3416, 1430, 740, 3992, 151, 3379, 1420, 892, 2598, 3746, 1922, 1475, 3930, 2679, 1560, 2436, 862, 1351, 2695, 3561, 2005, 1496, 3784, 806, 3471, 2720, 2350, 614, 3382, 402, 3797, 3032, 2046,
+	2726, 215, 3263, 2877, 289, 1769, 2181, 240, 3641, 1298, 141, 3838, 356, 994, 3755, 787, 3537, 2107, 3104, 812, 3880, 2318, 3288, 1380, 2754, 1952, 3427, 398, 2912, 4079, 1761, 1067, 2927, 2202, 1809, 1016, 2515, 2969, 2137, 586, 3247, 389, 3046, 850, 581, 3147, 3493, 169, 3883, 1748, 1040, 193, 2816, 392, 3030, 1098, 161, 3265, 1244, 1945, 2848, 1156, 2292, 915,
+	3860, 1622, 825, 2008, 1281, 3068, 3432, 2661, 1959, 3258, 2399, 1741, 2967, 2526, 1948, 2834, 1168, 2676, 3657, 386, 1967, 1005, 230, 3788, 481, 3189, 1521, 2514, 1322, 139, 2667, 565, 3812, 342, 3158, 1340, 3795, 261, 3476, 1594, 2274, 1086, 2545, 3557, 2252, 1831, 1097, 2946, 2094, 568, 3058, 3937, 2369, 1371, 1838, 3967, 2210, 1632, 3699, 2550, 12, 1788, 3442, 485,
+	3086, 1236, 3415, 3808, 2578, 529, 1011, 1498, 761, 2923, 1035, 549, 3612, 1331, 115, 3342, 1658, 252, 2416, 1413, 3377, 2528, 3029, 1612, 2371, 1029, 611, 3666, 2205, 3172, 3607, 1571, 2492, 889, 3594, 2324, 644, 1972, 979, 4039, 50, 3668, 1702, 1306, 132, 4090, 458, 1513, 2602, 3448, 1285, 1903, 612, 3676, 2531, 723, 2875, 436, 962, 3133, 737, 3969, 1519, 2501,
+	2134, 613, 2268, 17, 1563, 3565, 2342, 4032, 413, 3711, 1624, 3386, 2162, 747, 4045, 2283, 622, 3826, 953, 1760, 4080, 582, 1204, 3534, 1891, 3976, 2943, 1802, 874, 469, 1963, 1113, 3038, 2011, 89, 2703, 1678, 3229, 2839, 1292, 2673, 3152, 513, 2050, 3341, 2737, 2378, 3625, 817, 98, 2302, 3187, 960, 3323, 54, 1223, 3491, 1979, 3884, 1356, 2118, 2971, 1046, 232,
+	1820, 4000, 2836, 1077, 3121, 1930, 177, 2856, 1775, 2555, 7, 1217, 2662, 1835, 2985, 1105, 2791, 2075, 3259, 2949, 133, 2089, 2883, 760, 96, 2553, 359, 1183, 3871, 2450, 3354, 264, 4021, 1370, 3400, 1096, 3939, 316, 2289, 595, 1947, 901, 3925, 2956, 993, 640, 1753, 1246, 2991, 4002, 1642, 325, 2704, 1500, 2165, 3076, 1561, 2637, 205, 2411, 3584, 385, 2729, 3334,
+	877, 1426, 339, 2497, 3893, 832, 1339, 3292, 983, 2131, 3943, 3096, 459, 3790, 277, 1531, 3539, 432, 1268, 768, 2642, 1394, 3738, 2260, 3260, 1385, 3482, 2149, 3051, 1517, 754, 2806, 1726, 623, 2148, 2964, 770, 1497, 3710, 3332, 1565, 2462, 257, 2323, 1481, 3817, 3230, 344, 2043, 2534, 1107, 3796, 1958, 3591, 384, 4069, 920, 602, 3269, 1694, 664, 1919, 1277, 3690,
+	2586, 3037, 3553, 1735, 518, 2187, 3695, 2418, 610, 3466, 1446, 774, 2359, 1677, 3267, 865, 2551, 1940, 3945, 2290, 3457, 1685, 425, 980, 2755, 1699, 824, 2710, 32, 3533, 1234, 2243, 3671, 2619, 395, 3615, 1828, 2601, 1120, 184, 2907, 3602, 1214, 3451, 1867, 6, 2216, 3689, 955, 541, 3368, 2870, 743, 1181, 2600, 1794, 2306, 3794, 2811, 1142, 3397, 4046, 2354, 79,
+	1666, 592, 2076, 1254, 3431, 2784, 300, 1602, 3056, 235, 1954, 2866, 3603, 1195, 2183, 3723, 71, 1635, 3124, 331, 1076, 3073, 3902, 1969, 3610, 268, 4036, 1844, 642, 1993, 3922, 178, 875, 3266, 1458, 2406, 38, 3079, 2037, 4015, 784, 1732, 492, 2851, 815, 2620, 1324, 2780, 3160, 1878, 1439, 81, 2222, 3214, 558, 2965, 258, 1441, 2054, 122, 2593, 1544, 785, 3193,
+	1106, 3654, 2437, 112, 3099, 1043, 1974, 3981, 1215, 2609, 3810, 1030, 120, 2677, 566, 3044, 1118, 2768, 691, 3750, 1879, 16, 2461, 624, 1241, 3042, 2225, 1141, 3296, 2841, 2491, 1598, 2934, 1951, 1123, 3778, 913, 3399, 506, 1408, 2235, 2644, 3856, 2079, 3194, 4018, 653, 1617, 192, 3951, 2414, 3540, 1670, 3896, 1387, 3712, 1065, 3175, 3650, 880, 3048, 405, 2001, 3847,
+	270, 2865, 896, 4070, 1587, 563, 2660, 3272, 807, 1758, 520, 2242, 3235, 1874, 1428, 4022, 2048, 3406, 1474, 2622, 2239, 1366, 2860, 3391, 1609, 2558, 499, 3578, 1429, 333, 974, 3435, 531, 3998, 244, 2835, 2186, 1665, 2748, 3528, 3154, 313, 972, 1525, 228, 1128, 2364, 3461, 2078, 1191, 779, 2740, 978, 293, 2546, 1908, 2367, 650, 1628, 2227, 3890, 1233, 2721, 2250,
+	1773, 1346, 3321, 1861, 2312, 3724, 1397, 42, 2184, 2977, 3519, 1523, 3906, 847, 2906, 396, 2381, 219, 931, 3535, 546, 4050, 802, 2143, 194, 3875, 904, 2944, 2391, 1756, 3832, 2140, 1313, 2356, 3207, 1520, 665, 3923, 1004, 127, 1257, 1931, 3403, 2430, 3598, 1917, 3035, 334, 2849, 3756, 441, 3255, 2125, 3084, 706, 3511, 5, 2760, 3328, 296, 1818, 3488, 544, 3239,
+	3703, 2648, 652, 287, 2968, 830, 3426, 2490, 3787, 346, 1282, 2735, 246, 2470, 3582, 1054, 1600, 3800, 1812, 2916, 1205, 3176, 1795, 3600, 1059, 3228, 1987, 116, 3701, 711, 3157, 62, 2725, 752, 1842, 3484, 302, 2529, 1859, 2368, 3783, 2700, 672, 2972, 1307, 596, 3910, 988, 1460, 2552, 1911, 1304, 4051, 1738, 1189, 2950, 1503, 4006, 1249, 2580, 999, 2904, 1516, 861,
+	86, 2065, 3898, 2463, 1202, 2122, 433, 1679, 1078, 2021, 3343, 918, 1785, 600, 2009, 3367, 2709, 3105, 493, 2102, 171, 2562, 403, 1443, 2745, 2410, 1683, 1239, 2179, 2625, 1135, 1579, 3033, 3648, 1044, 2658, 1367, 3027, 3681, 753, 1495, 364, 4061, 1686, 69, 2689, 2173, 1755, 3326, 699, 3576, 363, 2458, 162, 3751, 2182, 835, 2030, 489, 3745, 2280, 222, 4037, 2396,
+	3067, 1541, 1033, 3504, 3113, 1511, 3965, 3209, 2864, 676, 4062, 2190, 3181, 3834, 1378, 48, 721, 1225, 2432, 3857, 1566, 3458, 2231, 3931, 680, 315, 3428, 4081, 525, 3286, 1870, 3953, 461, 2069, 190, 4071, 2223, 447, 1187, 3256, 2821, 2233, 1050, 2028, 3679, 3224, 871, 3635, 142, 2237, 3047, 1592, 878, 2717, 3212, 435, 2613, 3289, 1652, 3043, 717, 2003, 3314, 1199,
+	3618, 2770, 465, 1823, 114, 2683, 722, 1923, 209, 2523, 1568, 118, 1190, 2928, 2592, 2226, 4044, 1925, 3412, 964, 3050, 744, 1131, 2854, 1916, 3070, 811, 1529, 2888, 216, 3499, 928, 2521, 1332, 3188, 1717, 870, 3575, 2047, 8, 1780, 3547, 3069, 730, 2362, 1490, 324, 2507, 1335, 2783, 1055, 3869, 3388, 1863, 1442, 1045, 3806, 260, 1117, 3595, 1390, 2750, 1673, 388,
+	704, 1957, 3243, 842, 3773, 2355, 1147, 3683, 1382, 3506, 3098, 2353, 3675, 449, 854, 1655, 3163, 354, 1482, 102, 2670, 1968, 3682, 195, 1353, 3604, 2536, 2049, 1094, 2449, 692, 2214, 2939, 3802, 578, 2773, 3349, 1582, 2560, 3975, 632, 1373, 207, 2708, 1184, 3864, 3004, 1978, 3993, 522, 2066, 45, 2267, 603, 3624, 2331, 1716, 2880, 2100, 2431, 65, 3774, 947, 2304,
+	2573, 1348, 4030, 2234, 1447, 3378, 285, 2763, 2150, 490, 1072, 741, 1960, 1486, 3522, 2795, 1089, 3678, 2900, 2348, 3974, 486, 1619, 3315, 2314, 1017, 59, 3735, 3231, 1767, 3854, 1485, 77, 1783, 1109, 2394, 152, 702, 2941, 1047, 3191, 2445, 3731, 3336, 427, 1720, 671, 1099, 3232, 1772, 3667, 2894, 1270, 3078, 221, 2751, 695, 3996, 868, 3344, 552, 2980, 1801, 3900,
+	3025, 37, 1062, 2920, 371, 1985, 3063, 828, 4001, 1608, 2850, 3903, 2575, 3215, 159, 2363, 524, 2133, 796, 1797, 1194, 3197, 2605, 667, 4017, 1816, 2788, 635, 1301, 274, 2715, 1025, 3151, 3465, 2044, 3629, 1463, 3835, 2246, 335, 2006, 1634, 894, 1928, 2255, 2833, 3446, 2548, 239, 844, 1469, 2564, 755, 3926, 1999, 1342, 3166, 150, 1545, 1898, 2617, 1262, 3436, 341,
+	2099, 3702, 1762, 2638, 690, 3622, 1286, 1790, 2541, 3, 3443, 1764, 350, 1121, 3757, 1703, 3958, 1323, 3329, 3620, 297, 2113, 946, 2997, 1468, 374, 3463, 2117, 3960, 3023, 1981, 3687, 638, 2496, 387, 885, 3015, 1858, 1182, 3526, 2716, 3895, 542, 1264, 4041, 40, 1477, 3821, 2248, 2982, 3376, 304, 1750, 3430, 938, 2524, 3704, 2197, 3518, 1049, 3868, 2155, 783, 1569,
+	989, 540, 3148, 3505, 1578, 2475, 3828, 569, 3274, 2217, 1299, 637, 2295, 2987, 2040, 923, 2663, 23, 2452, 636, 1562, 3831, 2385, 97, 1996, 3142, 1174, 2476, 1524, 882, 414, 2278, 1607, 2886, 1325, 4025, 2537, 227, 3318, 736, 1404, 124, 2960, 2561, 3178, 1006, 2058, 562, 1222, 1855, 4057, 1104, 2230, 2787, 353, 1651, 537, 1196, 2955, 408, 2807, 201, 2525, 3278,
+	2826, 2293, 1258, 242, 966, 2136, 154, 1143, 2951, 914, 3761, 2712, 3405, 1410, 292, 3494, 3161, 1494, 3020, 1990, 2769, 3277, 1284, 3586, 2654, 3887, 759, 456, 3409, 2621, 3571, 1153, 3911, 126, 3389, 2129, 597, 1548, 2855, 2370, 3652, 2121, 3418, 1555, 709, 2407, 3623, 3294, 2752, 94, 2448, 634, 3628, 1290, 3071, 4026, 1956, 3311, 2438, 763, 1662, 3548, 1221, 4008,
+	294, 3776, 1961, 2581, 4056, 3299, 2775, 1875, 3496, 1553, 421, 1900, 849, 4072, 2471, 585, 1913, 843, 3867, 1146, 225, 804, 1860, 573, 1015, 1680, 2358, 2963, 1869, 11, 1706, 3220, 700, 2389, 1776, 1048, 3128, 3760, 1921, 965, 446, 1718, 1023, 365, 3753, 1847, 288, 1636, 857, 3717, 1488, 3208, 1938, 185, 2288, 803, 2664, 76, 1453, 3964, 3022, 2038, 630, 1829,
+	905, 1456, 3196, 746, 1771, 496, 1381, 2307, 301, 3924, 2147, 3173, 80, 1693, 2889, 1242, 3661, 2327, 445, 3468, 2508, 4058, 3010, 2299, 3310, 147, 3627, 1316, 3986, 973, 2817, 2115, 1384, 2736, 3727, 295, 2608, 1267, 22, 3950, 3066, 2464, 3849, 2185, 2800, 3100, 1305, 2520, 2999, 2128, 410, 2872, 969, 3852, 1577, 3477, 1136, 3659, 1866, 987, 2341, 111, 3180, 2435,
+	3502, 2684, 148, 3573, 2986, 1024, 3851, 2901, 813, 2544, 1134, 2843, 3640, 1010, 2124, 3261, 140, 1621, 2830, 2073, 1317, 1671, 370, 3716, 1455, 2804, 2052, 340, 2220, 3171, 567, 3606, 255, 891, 3282, 1589, 726, 3440, 2224, 2746, 1438, 703, 3238, 1216, 73, 933, 3999, 577, 3521, 1070, 3959, 1709, 2596, 3316, 554, 2878, 303, 2163, 3130, 439, 3611, 1283, 3886, 1618,
+	484, 2086, 1230, 2383, 1526, 2164, 43, 3613, 1627, 3237, 594, 1416, 2321, 451, 3873, 719, 2539, 3990, 986, 3253, 68, 2903, 959, 2095, 495, 1088, 3109, 790, 3698, 1203, 2456, 1527, 3941, 1888, 2935, 2276, 4085, 1784, 501, 1087, 3563, 196, 1964, 2650, 1768, 3365, 2277, 1941, 160, 1395, 2417, 733, 63, 2059, 1326, 2373, 1667, 3819, 705, 2828, 1584, 2566, 751, 2879,
+	3309, 3991, 712, 3749, 415, 3423, 2633, 1200, 2023, 247, 4011, 1857, 3452, 2724, 1510, 1892, 3064, 1374, 504, 1837, 3771, 2326, 3361, 2702, 3947, 1843, 3481, 1538, 2723, 1825, 107, 3411, 2169, 589, 1126, 383, 1364, 2857, 3218, 2017, 2559, 1570, 4040, 527, 3609, 1445, 757, 2772, 3305, 1779, 3135, 3544, 1145, 3688, 3026, 899, 3284, 2588, 1177, 2018, 3407, 263, 2192, 1132,
+	56, 1657, 2812, 1877, 2954, 910, 1799, 517, 3384, 2764, 2423, 841, 128, 1212, 3322, 276, 893, 2218, 3545, 2567, 767, 1235, 259, 1558, 698, 2516, 183, 2300, 473, 4086, 2873, 929, 3112, 2645, 3791, 3421, 2505, 924, 241, 3894, 775, 3298, 2931, 995, 2409, 2979, 368, 3705, 922, 2565, 311, 2106, 2777, 1811, 254, 4055, 497, 1464, 31, 3977, 909, 3003, 3686, 1901,
+	3141, 881, 2434, 202, 1295, 4042, 3119, 2329, 3734, 1028, 1573, 3799, 3114, 2010, 2349, 3827, 2792, 3236, 345, 1476, 3031, 4004, 1910, 3517, 3061, 1266, 3840, 3217, 1162, 715, 2029, 1293, 280, 1479, 1804, 64, 2090, 3729, 1690, 2402, 1255, 326, 2188, 1345, 129, 3830, 1646, 2144, 1232, 3940, 666, 1508, 3829, 801, 2607, 2206, 1712, 3589, 2789, 2382, 1798, 472, 1355, 2615,
+	3918, 1459, 3715, 3276, 2240, 669, 1550, 117, 1396, 654, 2097, 2831, 476, 1001, 3577, 663, 1704, 1119, 2019, 3664, 532, 2211, 1031, 2603, 390, 2061, 895, 1707, 2926, 3467, 2535, 3823, 3264, 2287, 853, 2981, 1226, 3304, 675, 3087, 1912, 3739, 2759, 1727, 3398, 838, 2671, 3216, 10, 3438, 2339, 3039, 471, 1405, 3520, 1110, 3155, 2091, 604, 1250, 3337, 3777, 2284, 629,
+	310, 2101, 1108, 482, 2781, 1992, 3805, 2532, 2929, 3251, 233, 3532, 1786, 2568, 1471, 105, 2635, 3970, 218, 2699, 1682, 2882, 21, 3876, 1505, 2413, 3709, 91, 2215, 1473, 355, 1743, 620, 3645, 2680, 3997, 455, 1551, 2722, 138, 3497, 961, 609, 3917, 1980, 2351, 494, 1425, 1946, 2762, 1700, 1051, 3383, 2297, 121, 2744, 366, 926, 3862, 2911, 284, 1640, 1026, 2895,
+	3523, 2569, 1688, 3590, 860, 3345, 376, 1101, 1890, 3942, 2281, 1252, 749, 4052, 2988, 2167, 3395, 1388, 2315, 967, 3293, 1296, 3434, 839, 3182, 553, 3404, 2688, 645, 3921, 1064, 3000, 2071, 1169, 229, 1937, 2427, 3593, 1069, 2228, 1372, 2597, 3246, 198, 1133, 3145, 4091, 1008, 3719, 776, 272, 4013, 2004, 2917, 1596, 3955, 1909, 3369, 1432, 2229, 829, 2698, 3280, 1873,
+	713, 3168, 174, 2682, 1350, 1759, 2871, 3543, 526, 864, 1540, 2728, 3424, 336, 1083, 1807, 814, 480, 3057, 3754, 688, 2447, 2036, 1729, 2824, 1124, 1850, 1309, 3107, 1965, 3551, 4, 2493, 3413, 1499, 3165, 643, 1791, 3021, 4087, 430, 1710, 2325, 1506, 2810, 400, 1610, 2952, 2171, 3252, 1365, 2641, 420, 858, 3631, 587, 1167, 2549, 87, 3115, 1935, 4092, 131, 1379,
+	2212, 996, 4005, 2328, 3763, 52, 2245, 1483, 2478, 3036, 3721, 15, 2020, 2376, 3177, 3853, 2713, 3562, 1886, 1512, 144, 4073, 488, 3630, 165, 2279, 4014, 332, 2388, 837, 2734, 1620, 3966, 793, 2802, 1027, 3842, 72, 809, 2002, 2742, 3804, 762, 3469, 2123, 3601, 2527, 655, 175, 2459, 3552, 1848, 3137, 1302, 2495, 2152, 3016, 3815, 1576, 3529, 547, 1213, 2441, 3680,
+	2973, 1451, 1833, 588, 1114, 3131, 820, 4082, 217, 1175, 1792, 3283, 971, 1590, 530, 1287, 75, 2236, 1129, 2803, 2172, 2984, 1186, 2594, 1537, 3012, 902, 3447, 1572, 3271, 515, 1219, 2259, 393, 2007, 3485, 2269, 2589, 1487, 3331, 1155, 155, 2947, 1272, 286, 900, 1914, 3874, 1171, 1661, 523, 935, 3841, 49, 3355, 1724, 262, 764, 2357, 1014, 2655, 3356, 1692, 437,
+	3836, 231, 3433, 3014, 2074, 3501, 1876, 2687, 3374, 2109, 453, 2446, 3897, 2819, 3583, 2481, 1696, 3257, 312, 3839, 735, 1814, 3450, 822, 3786, 511, 2085, 2614, 213, 3669, 1920, 2940, 3725, 3200, 1643, 279, 1261, 3083, 3767, 468, 2244, 3608, 1885, 2439, 3971, 3017, 1362, 3301, 2675, 3691, 2936, 2033, 2387, 1515, 2785, 1041, 3580, 1995, 2910, 319, 3748, 2098, 819, 2749,
+	1989, 2467, 856, 2611, 283, 1546, 431, 1318, 689, 3792, 2862, 1406, 710, 256, 1975, 789, 2922, 3694, 975, 2543, 3132, 1419, 223, 2330, 1932, 3203, 1100, 3870, 1328, 2309, 970, 123, 1398, 685, 2628, 4020, 619, 1817, 939, 2861, 1647, 661, 3227, 990, 1674, 536, 2286, 9, 805, 2151, 327, 1237, 3487, 729, 4074, 464, 3138, 1192, 3957, 1714, 1321, 0, 3198, 1125,
+	516, 3626, 1681, 1248, 3961, 2847, 3646, 2375, 3123, 1653, 1007, 3201, 2199, 3422, 1208, 4043, 1465, 599, 2070, 1675, 424, 3915, 2766, 3320, 1311, 39, 2753, 1822, 707, 3156, 4038, 2465, 3495, 2064, 1084, 2899, 2204, 3637, 189, 2472, 3980, 1329, 2651, 104, 3732, 2796, 3460, 1803, 3167, 1489, 3913, 3052, 206, 2646, 1899, 2258, 1470, 2610, 560, 2285, 3053, 2591, 4010, 1583,
+	2305, 2930, 70, 3241, 2191, 778, 1057, 2016, 348, 2616, 84, 3983, 1746, 2572, 3065, 135, 2337, 2747, 3324, 1211, 3500, 2139, 1063, 539, 4003, 1650, 3572, 438, 2898, 2015, 1585, 528, 2801, 1739, 3744, 60, 1360, 3307, 2024, 1091, 3060, 337, 2153, 3346, 1224, 2060, 879, 4075, 491, 2542, 991, 2308, 1615, 3273, 927, 3651, 163, 3401, 883, 3684, 434, 1839, 745, 3392,
+	1399, 942, 3772, 1853, 533, 2488, 3195, 3879, 1275, 3439, 1950, 633, 1297, 379, 950, 3550, 1864, 467, 3803, 55, 2512, 758, 1845, 2468, 2966, 2203, 934, 2482, 3811, 167, 1140, 3380, 887, 378, 2404, 3185, 766, 2711, 1534, 561, 3531, 1796, 3885, 687, 2474, 375, 1552, 2692, 1294, 3554, 1893, 682, 3764, 426, 1274, 2500, 1800, 2959, 2053, 1507, 3290, 1176, 2479, 208,
+};
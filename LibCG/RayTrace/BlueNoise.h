@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../KDMath.h"
+
+const u32 BLUE_NOISE_SIZE = 64;
+
+/**
+* Toroidal void and cluster rank tile, every value 0..4095 once. Pixels below any threshold are evenly
+* spread with no low frequency clumps, so per-pixel values taken from it make the error blue noise.
+*/
+extern const u16 BLUE_NOISE_TILE[BLUE_NOISE_SIZE * BLUE_NOISE_SIZE];
+
+//rank at a pixel, the tile repeats over the screen
+inline u32 blue_noise(u32 x, u32 y)
+{
+	return BLUE_NOISE_TILE[(x % BLUE_NOISE_SIZE) + (y % BLUE_NOISE_SIZE) * BLUE_NOISE_SIZE];
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "../KDMath.h"
+#include "../Util.h"
+#include "Primitive.h"
+#include "Sampler.h"
+#include "Sampling.h"
+
+/**
+* BSDFs of the material types. Every function is a template on MaterialType so a loop over hits of one
+* type runs one kernel without a per hit branch on the type, the wavefront shade stage calls them per
+* material batch. The non template overloads switch on the type for code shading one path at a time.
+* Directions point away from the surface, n is the normal on the side of wo, returned values have cos folded in.
+*/
+
+struct BsdfSample
+{
+	vec3<f32> wi;
+	//f * cos / pdf
+	vec3<f32> weight;
+	//solid angle pdf, 0 for a specular bounce that a light sample can't produce
+	f32 pdf = 0.0f;
+};
+
+//specular only, no light samples
+template<MaterialType type>
+constexpr bool bsdf_is_delta()
+{
+	return type == MaterialType::Mirror || type == MaterialType::Glass;
+}
+
+inline vec3<f32> reflect_direction(const vec3<f32>& wo, const vec3<f32>& n)
+{
+	return n * (2.0f * dot(wo, n)) - wo;
+}
+
+inline f32 schlick_weight(f32 cosTheta)
+{
+	f32 m = min(max(1.0f - cosTheta, 0.0f), 1.0f);
+	f32 m2 = m * m;
+	return m2 * m2 * m;
+}
+
+//unpolarized Fresnel reflectance of a dielectric, eta = incident ior / transmitted ior
+inline f32 fresnel_dielectric(f32 cosI, f32 eta, f32& cosT)
+{
+	f32 sin2T = eta * eta * max(0.0f, 1.0f - cosI * cosI);
+	if (sin2T >= 1.0f)
+	{
+		cosT = 0.0f;
+		return 1.0f;
+	}
+	cosT = sqrtf(1.0f - sin2T);
+	f32 rs = (eta * cosI - cosT) / (eta * cosI + cosT);
+	f32 rp = (cosI - eta * cosT) / (cosI + eta * cosT);
+	return 0.5f * (rs * rs + rp * rp);
+}
+
+//Disney lobes, GGX specular with separable Smith masking
+namespace DisneyLobes
+{
+	inline f32 alpha(const Material& material)
+	{
+		return max(material.roughness * material.roughness, 1e-3f);
+	}
+
+	inline f32 ggx_d(f32 NoH, f32 a2)
+	{
+		f32 d = NoH * NoH * (a2 - 1.0f) + 1.0f;
+		return a2 / (F32_PI * d * d);
+	}
+
+	inline f32 smith_g1(f32 NoX, f32 a2)
+	{
+		return 2.0f * NoX / (NoX + sqrtf(a2 + (1.0f - a2) * NoX * NoX));
+	}
+
+	//specular reflectance at normal incidence, dielectric from the ior, metals tinted by the base color
+	inline vec3<f32> f0(const Material& material)
+	{
+		f32 r = (material.ior - 1.0f) / (material.ior + 1.0f);
+		vec3<f32> dielectric(r * r);
+		return dielectric + (material.color - dielectric) * material.metallic;
+	}
+
+	//probability of sampling the specular lobe, all of it for a metal
+	inline f32 specular_probability(const Material& material)
+	{
+		return 0.5f + 0.5f * material.metallic;
+	}
+}
+
+/**
+* f * cos of the BSDF from wo to wi, zero for specular lobes
+* @param pdf solid angle pdf sample_bsdf has of producing wi
+*/
+template<MaterialType type>
+vec3<f32> eval_bsdf(const Material& material, const vec3<f32>& wo, const vec3<f32>& wi, const vec3<f32>& n, f32& pdf)
+{
+	pdf = 0.0f;
+	f32 NoL = dot(n, wi);
+	if constexpr (bsdf_is_delta<type>())
+	{
+		return vec3<f32>(0.0f);
+	}
+	else if constexpr (type == MaterialType::Lambert)
+	{
+		if (NoL <= 0.0f)
+			return vec3<f32>(0.0f);
+		pdf = NoL * F32_1_FRAC_PI;
+		return material.color * pdf;
+	}
+	else
+	{
+		using namespace DisneyLobes;
+		f32 NoV = dot(n, wo);
+		if (NoL <= 0.0f || NoV <= 0.0f)
+			return vec3<f32>(0.0f);
+		vec3<f32> h = normalize(wo + wi);
+		f32 NoH = dot(n, h);
+		f32 LoH = dot(wi, h);
+		f32 a2 = alpha(material) * alpha(material);
+
+		//Burley diffuse, retro-reflection grows with roughness
+		f32 fd90 = 0.5f + 2.0f * LoH * LoH * material.roughness;
+		f32 fl = schlick_weight(NoL);
+		f32 fv = schlick_weight(NoV);
+		vec3<f32> diffuse = material.color * (F32_1_FRAC_PI * (1.0f - material.metallic)
+			* (1.0f + (fd90 - 1.0f) * fl) * (1.0f + (fd90 - 1.0f) * fv));
+
+		f32 D = ggx_d(NoH, a2);
+		f32 G = smith_g1(NoL, a2) * smith_g1(NoV, a2);
+		vec3<f32> F0 = f0(material);
+		vec3<f32> F = F0 + (vec3<f32>(1.0f) - F0) * schlick_weight(LoH);
+		vec3<f32> specular = F * (D * G / (4.0f * NoL * NoV));
+
+		f32 pSpecular = specular_probability(material);
+		pdf = (1.0f - pSpecular) * NoL * F32_1_FRAC_PI + pSpecular * D * NoH / (4.0f * LoH);
+		return (diffuse + specular) * NoL;
+	}
+}
+
+/**
+* Next direction of the path, Glass refracts into the side of n opposite to wo
+* @return false when the sampled direction is below the surface and the path ends
+*/
+template<MaterialType type>
+bool sample_bsdf(const HitInfo& hit, const vec3<f32>& wo, const vec3<f32>& n, Sampler& sampler, BsdfSample& sample)
+{
+	const Material& material = hit.material;
+	if constexpr (type == MaterialType::Lambert)
+	{
+		vec2<f32> u = sampler.get2D(SampleDimension::Bsdf);
+		cosine_sample_hemisphere(u.x, u.y, sample.wi, sample.pdf);
+		sample.wi = tangent_to_world(sample.wi, n);
+		sample.weight = material.color;
+		return true;
+	}
+	else if constexpr (type == MaterialType::Mirror)
+	{
+		sample.wi = reflect_direction(wo, n);
+		sample.weight = material.color;
+		sample.pdf = 0.0f;
+		return true;
+	}
+	else if constexpr (type == MaterialType::Glass)
+	{
+		//the geometric normal points outside, n was flipped toward wo when the path is inside
+		bool entering = dot(hit.normal, n) > 0.0f;
+		f32 eta = entering ? 1.0f / material.ior : material.ior;
+		f32 cosI = dot(wo, n);
+		f32 cosT;
+		f32 F = fresnel_dielectric(cosI, eta, cosT);
+		sample.pdf = 0.0f;
+		//pick reflection with probability F, F cancels out of the weight
+		if (sampler.get1D(SampleDimension::BsdfLobe) < F)
+		{
+			sample.wi = reflect_direction(wo, n);
+			sample.weight = vec3<f32>(1.0f);
+		}
+		else
+		{
+			sample.wi = normalize(wo * -eta + n * (eta * cosI - cosT));
+			sample.weight = material.color;
+		}
+		return true;
+	}
+	else
+	{
+		using namespace DisneyLobes;
+		vec2<f32> u = sampler.get2D(SampleDimension::Bsdf);
+		if (sampler.get1D(SampleDimension::BsdfLobe) < specular_probability(material))
+		{
+			//GGX distribution of visible and hidden normals, reflected about the sampled half vector
+			f32 a2 = alpha(material) * alpha(material);
+			f32 phi = u.x * F32_2PI;
+			f32 cosTheta = sqrtf((1.0f - u.y) / (1.0f + (a2 - 1.0f) * u.y));
+			f32 sinTheta = sqrtf(max(0.0f, 1.0f - cosTheta * cosTheta));
+			vec3<f32> h = tangent_to_world(vec3<f32>(sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta), n);
+			sample.wi = reflect_direction(wo, h);
+		}
+		else
+		{
+			f32 pdf;
+			cosine_sample_hemisphere(u.x, u.y, sample.wi, pdf);
+			sample.wi = tangent_to_world(sample.wi, n);
+		}
+		vec3<f32> f = eval_bsdf<type>(material, wo, sample.wi, n, sample.pdf);
+		if (sample.pdf <= 0.0f)
+			return false;
+		sample.weight = f / sample.pdf;
+		return true;
+	}
+}
+
+/**
+* BSDF side of a light sample toward wi, f * cos with the MIS weight against BSDF sampling
+*/
+template<MaterialType type>
+vec3<f32> light_sample_weight(const Material& material, const vec3<f32>& wo, const vec3<f32>& wi, const vec3<f32>& n, f32 lightPdf)
+{
+	f32 pdf;
+	vec3<f32> f = eval_bsdf<type>(material, wo, wi, n, pdf);
+	return f * power_heuristic(lightPdf, pdf);
+}
+
+//per path dispatch
+
+inline bool bsdf_is_delta(MaterialType type)
+{
+	return type == MaterialType::Mirror || type == MaterialType::Glass;
+}
+
+inline bool sample_bsdf(const HitInfo& hit, const vec3<f32>& wo, const vec3<f32>& n, Sampler& sampler, BsdfSample& sample)
+{
+	switch (hit.material.type)
+	{
+	case MaterialType::Mirror: return sample_bsdf<MaterialType::Mirror>(hit, wo, n, sampler, sample);
+	case MaterialType::Glass: return sample_bsdf<MaterialType::Glass>(hit, wo, n, sampler, sample);
+	case MaterialType::Disney: return sample_bsdf<MaterialType::Disney>(hit, wo, n, sampler, sample);
+	default: return sample_bsdf<MaterialType::Lambert>(hit, wo, n, sampler, sample);
+	}
+}
+
+inline vec3<f32> light_sample_weight(const Material& material, const vec3<f32>& wo, const vec3<f32>& wi, const vec3<f32>& n, f32 lightPdf)
+{
+	switch (material.type)
+	{
+	case MaterialType::Mirror: return light_sample_weight<MaterialType::Mirror>(material, wo, wi, n, lightPdf);
+	case MaterialType::Glass: return light_sample_weight<MaterialType::Glass>(material, wo, wi, n, lightPdf);
+	case MaterialType::Disney: return light_sample_weight<MaterialType::Disney>(material, wo, wi, n, lightPdf);
+	default: return light_sample_weight<MaterialType::Lambert>(material, wo, wi, n, lightPdf);
+	}
+}
@@ -1,15 +1,22 @@
 ﻿#include "Bvh.h"
 #include "RayIntersection.h"
+#include "TraversalStats.h"
 #include "../ModelLoader.h"
+#include "../ThreadPool.h"
 #include <algorithm>
 
 bool BVHNode::rayIntersect(const ray& ray, HitInfo& hitInfo)
 {
+	count_node();
 	if (ray_aabb_intersect(aabb.min, aabb.max, ray))
 	{
 		if (primitive)
 		{
-			return primitive->rayIntersect(ray, hitInfo);
+			count_primitive();
+			if (!primitive->rayIntersect(ray, hitInfo))
+				return false;
+			hitInfo.primitive = primitive;
+			return true;
 		}
 		else
 		{
@@ -44,6 +51,23 @@ bool BVHNode::rayIntersect(const ray& ray, HitInfo& hitInfo)
 		return false;
 }
 
+bool BVHNode::rayOccluded(const ray& ray)
+{
+	count_node();
+	if (!ray_aabb_intersect(aabb.min, aabb.max, ray))
+		return false;
+
+	if (primitive)
+	{
+		HitInfo hitInfo;
+		count_primitive();
+		return primitive->rayIntersect(ray, hitInfo) && hitInfo.t > ray.tMin && hitInfo.t < ray.tMax;
+	}
+
+	//first hit is enough, no need to find the closest
+	return left->rayOccluded(ray) || right->rayOccluded(ray);
+}
+
 bool BVHAccel::loadFormObj(const char* filename)
 {
 	ObjLoader loader;
@@ -62,12 +86,35 @@ bool BVHAccel::loadFormVox(const char* filename)
 	return true;
 }
 
+bool BVHAccel::loadFormVoxTree(const char* filename)
+{
+	VoxLoader loader;
+	PrimitiveVoxelTree* primVoxelTree = new PrimitiveVoxelTree();
+	if (!loader.loadVoxelTree(filename, primVoxelTree->tree))
+	{
+		delete primVoxelTree;
+		return false;
+	}
+
+	primVoxelTree->updateAabb();
+	primitives.push_back(primVoxelTree);
+	return true;
+}
+
 void BVHAccel::build()
 {
-	if (primitives.size() < 3)
+	version++;
+	//before the sort below reorders primitives
+	for (auto& prim : primitives)
+	{
+		if (prim->id < 0)
+			prim->id = nextPrimitiveId++;
+	}
+	lightList.build(primitives);
+	if (primitives.empty())
 		return;
 
-	root = buildRecursive(0, primitives.size() - 1);
+	root = buildRecursive(0, primitives.size());
 }
 
 static bool box_x_compare(const Primitive* a, const Primitive* b)
@@ -85,12 +132,28 @@ static bool box_z_compare(const Primitive* a, const Primitive* b)
 	return a->aabb.min.z < b->aabb.min.z;
 }
 
+//subtrees above this many primitives are built on their own task
+static const size_t PARALLEL_BUILD_PRIMITIVES = 4096;
+
+//lowbias32 of the range
+static u32 range_hash(size_t start, size_t end)
+{
+	u32 x = u32(start) * 0x9e3779b9u ^ u32(end);
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
 BVHNode* BVHAccel::buildRecursive(size_t start, size_t end)
 {
 	BVHNode* node = new BVHNode();
 
 	//随机选轴->3轴中跨度最大
-	int axis = int(3 * rand() / RAND_MAX);
+	//hashed from the range instead of rand(), the same tree whichever thread builds the node
+	int axis = int(range_hash(start, end) % 3);
 
 	auto comparator = (axis == 0) ? box_x_compare
 		: (axis == 1) ? box_y_compare : box_z_compare;
@@ -134,8 +197,18 @@ BVHNode* BVHAccel::buildRecursive(size_t start, size_t end)
 		std::sort(primitives.begin() + start, primitives.begin() + end, comparator);
 
 		size_t mid = start + primNum / 2;
-		node->left = buildRecursive(start, mid);
-		node->right = buildRecursive(mid, end);
+		if (primNum > PARALLEL_BUILD_PRIMITIVES)
+		{
+			TaskGroup group;
+			group.run([&]() { node->left = buildRecursive(start, mid); });
+			node->right = buildRecursive(mid, end);
+			group.wait();
+		}
+		else
+		{
+			node->left = buildRecursive(start, mid);
+			node->right = buildRecursive(mid, end);
+		}
 	}
 
 	node->aabb.min = min(node->left->aabb.min, node->right->aabb.min);
@@ -151,15 +224,40 @@ bool BVHAccel::rayIntersect(const ray& ray, HitInfo& hitInfo) const
 		HitInfo _hitInfo;
 		for (auto& prim : primitives)
 		{
+			count_primitive();
 			prim->rayIntersect(ray, _hitInfo);
 			if (_hitInfo.t < hitInfo.t)
+			{
 				hitInfo = _hitInfo;
+				hitInfo.primitive = prim;
+			}
 		}
 		return hitInfo.t < F32_INF;
 	}
 	else if (mode == BVHAccelMode::Middle)
 	{
-		return root->rayIntersect(ray, hitInfo);
+		return root && root->rayIntersect(ray, hitInfo);
+	}
+	else
+		return false;
+}
+
+bool BVHAccel::rayOccluded(const ray& ray) const
+{
+	if (mode == BVHAccelMode::None)
+	{
+		for (auto& prim : primitives)
+		{
+			HitInfo hitInfo;
+			count_primitive();
+			if (prim->rayIntersect(ray, hitInfo) && hitInfo.t > ray.tMin && hitInfo.t < ray.tMax)
+				return true;
+		}
+		return false;
+	}
+	else if (mode == BVHAccelMode::Middle)
+	{
+		return root && root->rayOccluded(ray);
 	}
 	else
 		return false;
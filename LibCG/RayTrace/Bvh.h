@@ -2,10 +2,11 @@
 
 #include <vector>
 #include "Primitive.h"
+#include "Light.h"
 
 struct BVHNode
 {
-	aabb aabb;
+	::aabb aabb;
 	//is_leaf
 	Primitive* primitive = nullptr;
 
@@ -13,6 +14,8 @@ struct BVHNode
 	BVHNode* right = nullptr;
 
 	bool rayIntersect(const ray& ray, HitInfo& hitInfo);
+	//any hit in (ray.tMin, ray.tMax)
+	bool rayOccluded(const ray& ray);
 };
 
 enum struct BVHAccelMode
@@ -27,10 +30,18 @@ struct BVHAccel
 	BVHAccelMode mode = BVHAccelMode::Middle;
 	BVHNode* root = nullptr;
 	std::vector<Primitive*> primitives;
+	//bumped by build, lets the renderer notice scene changes
+	u32 version = 0;
+	//emissive primitives, rebuilt by build
+	LightList lightList;
+	//next Primitive::id to hand out
+	i32 nextPrimitiveId = 0;
 
 	bool loadFormObj(const char* filename);
 	bool loadFormVox(const char* filename);
+	bool loadFormVoxTree(const char* filename);
 	void build();
 	BVHNode* buildRecursive(size_t start, size_t end);
 	bool rayIntersect(const ray& ray, HitInfo& hitInfo) const;
+	bool rayOccluded(const ray& ray) const;
 };
@@ -0,0 +1,374 @@
+#include "Denoise.h"
+#include "../ThreadPool.h"
+#include "../Util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DENOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+static const i32 ROWS_PER_TASK = 16;
+
+//B3 spline, separable 5x5
+static const f32 KERNEL[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+static const f32 EPSILON = 1e-4f;
+
+static void for_rows(i32 height, bool parallel, const std::function<void(i32 y)>& func)
+{
+	if (!parallel)
+	{
+		for (i32 y = 0; y < height; y++)
+			func(y);
+		return;
+	}
+	parallel_for(u32(height), ROWS_PER_TASK, [&](u32 begin, u32 end)
+		{
+			for (i32 y = i32(begin); y < i32(end); y++)
+				func(y);
+		});
+}
+
+//albedo divided out of beauty, black channels are filtered as they are
+static inline vec3<f32> demodulation(const f32* albedo)
+{
+	return vec3<f32>(albedo[0] > 1e-3f ? albedo[0] : 1.0f, albedo[1] > 1e-3f ? albedo[1] : 1.0f, albedo[2] > 1e-3f ? albedo[2] : 1.0f);
+}
+
+static inline f32 finite_or_zero(f32 x)
+{
+	return std::isfinite(x) ? x : 0.0f;
+}
+
+static inline f32 pow_int(f32 x, u32 n)
+{
+	f32 result = 1.0f;
+	for (; n; n >>= 1, x *= x)
+	{
+		if (n & 1)
+			result *= x;
+	}
+	return result;
+}
+
+#ifdef DENOISE_SSE2
+//e^x for x <= 0, 2^fraction by a degree 5 polynomial, relative error under 2e-4
+static inline __m128 exp_sse(__m128 x)
+{
+	x = _mm_max_ps(x, _mm_set1_ps(-87.0f));
+	__m128 t = _mm_mul_ps(x, _mm_set1_ps(1.44269504f));
+	__m128i ti = _mm_cvttps_epi32(t);
+	__m128 fi = _mm_cvtepi32_ps(ti);
+	//truncation rounds negative values up, step down to the floor
+	__m128 up = _mm_cmpgt_ps(fi, t);
+	fi = _mm_sub_ps(fi, _mm_and_ps(up, _mm_set1_ps(1.0f)));
+	__m128 f = _mm_sub_ps(t, fi);
+	__m128 p = _mm_set1_ps(1.33336e-3f);
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(9.61813e-3f));
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(5.55041e-2f));
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(2.40227e-1f));
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(6.93147e-1f));
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+	__m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fi), _mm_set1_epi32(127)), 23);
+	return _mm_mul_ps(p, _mm_castsi128_ps(e));
+}
+
+static inline __m128 pow_int_sse(__m128 x, u32 n)
+{
+	__m128 result = _mm_set1_ps(1.0f);
+	for (; n; n >>= 1, x = _mm_mul_ps(x, x))
+	{
+		if (n & 1)
+			result = _mm_mul_ps(result, x);
+	}
+	return result;
+}
+
+static inline __m128 abs_sse(__m128 x)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+//normal and exponential weights underflow to denormals far from edges, which run at a fraction of the speed
+struct FlushDenormals
+{
+	u32 csr;
+	FlushDenormals() : csr(_mm_getcsr()) { _mm_setcsr(csr | 0x8040); }
+	~FlushDenormals() { _mm_setcsr(csr); }
+};
+
+static inline __m128 luminance_sse(__m128 r, __m128 g, __m128 b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(0.2126f)), _mm_mul_ps(g, _mm_set1_ps(0.7152f))), _mm_mul_ps(b, _mm_set1_ps(0.0722f)));
+}
+#endif
+
+void Denoiser::resize(i32 width, i32 height, int iterations)
+{
+	//widest pass reaches 2 * 2^(iterations - 1), plus 3 lanes of the last SIMD group past the row end
+	i32 pad = (1 << iterations) + 4;
+	if (this->width == width && this->height == height && this->pad == pad)
+		return;
+
+	this->width = width;
+	this->height = height;
+	this->pad = pad;
+	stride = width + 2 * pad;
+	size_t size = size_t(stride) * height;
+	for (int i = 0; i < 2; i++)
+	{
+		for (int c = 0; c < 3; c++)
+			color[i][c].assign(size, 0.0f);
+		variance[i].assign(size, 0.0f);
+	}
+	sigma.assign(size, 0.0f);
+	for (int c = 0; c < 3; c++)
+		normal[c].assign(size, 0.0f);
+	depth.assign(size, 0.0f);
+	gradient.assign(size, 0.0f);
+}
+
+void Denoiser::prepareRow(const AovBuffers& aovs, i32 y)
+{
+	const f32* beauty = aovs.plane(Aov::Beauty);
+	const f32* albedo = aovs.plane(Aov::Albedo);
+	const f32* normals = aovs.plane(Aov::Normal);
+	const f32* depths = aovs.plane(Aov::Depth);
+	const f32* variances = aovs.plane(Aov::Variance);
+
+	for (i32 x = 0; x < width; x++)
+	{
+		size_t i = size_t(y) * width + x;
+		size_t p = size_t(y) * stride + pad + x;
+		f32 z = depths[i];
+		vec3<f32> n(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+		f32 length = sqrtf(dot(n, n));
+		if (!(z > 0.0f) || !(length > 0.0f))
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				color[0][c][p] = 0.0f;
+				normal[c][p] = 0.0f;
+			}
+			variance[0][p] = 0.0f;
+			depth[p] = 0.0f;
+			gradient[p] = 0.0f;
+			continue;
+		}
+
+		vec3<f32> factor = demodulation(albedo + i * 3);
+		for (int c = 0; c < 3; c++)
+		{
+			color[0][c][p] = finite_or_zero(beauty[i * 3 + c]) / factor[c];
+			normal[c][p] = n[c] / length;
+		}
+		f32 scale = luminance(factor);
+		variance[0][p] = finite_or_zero(variances[i]) / (scale * scale);
+		depth[p] = z;
+
+		//largest step to a covered 4-neighbour
+		f32 g = 0.0f;
+		if (x > 0 && depths[i - 1] > 0.0f) g = max(g, fabsf(depths[i - 1] - z));
+		if (x + 1 < width && depths[i + 1] > 0.0f) g = max(g, fabsf(depths[i + 1] - z));
+		if (y > 0 && depths[i - width] > 0.0f) g = max(g, fabsf(depths[i - width] - z));
+		if (y + 1 < height && depths[i + width] > 0.0f) g = max(g, fabsf(depths[i + width] - z));
+		gradient[p] = g;
+	}
+}
+
+void Denoiser::blurVarianceRow(int src, i32 y)
+{
+	static const f32 BLUR[3] = { 0.25f, 0.5f, 0.25f };
+	const f32* var = variance[src].data();
+	f32* out = sigma.data() + size_t(y) * stride + pad;
+	for (i32 x = 0; x < width; x++)
+	{
+		f32 sum = 0.0f;
+		f32 weight = 0.0f;
+		for (i32 dy = -1; dy <= 1; dy++)
+		{
+			i32 yq = y + dy;
+			if (yq < 0 || yq >= height)
+				continue;
+			//padding has zero variance, rows at the image border are renormalized instead
+			const f32* row = var + size_t(yq) * stride + pad + x;
+			sum += BLUR[dy + 1] * (0.25f * row[-1] + 0.5f * row[0] + 0.25f * row[1]);
+			weight += BLUR[dy + 1];
+		}
+		out[x] = sqrtf(max(sum / weight, 0.0f));
+	}
+}
+
+void Denoiser::filterRow(int src, i32 y, i32 step, const DenoiseSettings& settings)
+{
+	const f32* srcR = color[src][0].data();
+	const f32* srcG = color[src][1].data();
+	const f32* srcB = color[src][2].data();
+	const f32* srcVar = variance[src].data();
+	f32* dstR = color[1 - src][0].data();
+	f32* dstG = color[1 - src][1].data();
+	f32* dstB = color[1 - src][2].data();
+	f32* dstVar = variance[1 - src].data();
+	const f32* nx = normal[0].data();
+	const f32* ny = normal[1].data();
+	const f32* nz = normal[2].data();
+	const f32* z = depth.data();
+	size_t row = size_t(y) * stride + pad;
+	i32 x = 0;
+
+#ifdef DENOISE_SSE2
+	FlushDenormals flush;
+	//4 neighbouring pixels share every tap row, loads are contiguous in the padded planes
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 epsilon = _mm_set1_ps(EPSILON);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 sigmaLuminance = _mm_set1_ps(settings.sigmaLuminance);
+	for (; x < width; x += 4)
+	{
+		size_t p = row + x;
+		__m128 zp = _mm_loadu_ps(z + p);
+		__m128 lp = luminance_sse(_mm_loadu_ps(srcR + p), _mm_loadu_ps(srcG + p), _mm_loadu_ps(srcB + p));
+		__m128 invLuminance = _mm_div_ps(one, _mm_add_ps(_mm_mul_ps(sigmaLuminance, _mm_loadu_ps(sigma.data() + p)), epsilon));
+		//tap offsets are 0 to 4 steps apart in L1, one reciprocal each instead of a division per tap
+		__m128 depthScale = _mm_mul_ps(_mm_set1_ps(settings.sigmaDepth * step), _mm_loadu_ps(gradient.data() + p));
+		__m128 invDepth[5];
+		for (int d = 0; d < 5; d++)
+			invDepth[d] = _mm_div_ps(one, _mm_add_ps(_mm_mul_ps(depthScale, _mm_set1_ps(f32(d))), epsilon));
+		__m128 nxp = _mm_loadu_ps(nx + p);
+		__m128 nyp = _mm_loadu_ps(ny + p);
+		__m128 nzp = _mm_loadu_ps(nz + p);
+
+		__m128 sumW = zero, sumR = zero, sumG = zero, sumB = zero, sumVar = zero;
+		for (i32 dy = -2; dy <= 2; dy++)
+		{
+			i32 yq = y + dy * step;
+			if (yq < 0 || yq >= height)
+				continue;
+			for (i32 dx = -2; dx <= 2; dx++)
+			{
+				size_t q = size_t(yq) * stride + pad + x + dx * step;
+				__m128 zq = _mm_loadu_ps(z + q);
+				__m128 r = _mm_loadu_ps(srcR + q);
+				__m128 g = _mm_loadu_ps(srcG + q);
+				__m128 b = _mm_loadu_ps(srcB + q);
+
+				__m128 wz = _mm_mul_ps(abs_sse(_mm_sub_ps(zp, zq)), invDepth[abs(dx) + abs(dy)]);
+				__m128 wl = _mm_mul_ps(abs_sse(_mm_sub_ps(lp, luminance_sse(r, g, b))), invLuminance);
+				__m128 nDot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nxp, _mm_loadu_ps(nx + q)), _mm_mul_ps(nyp, _mm_loadu_ps(ny + q))), _mm_mul_ps(nzp, _mm_loadu_ps(nz + q)));
+				__m128 wn = pow_int_sse(_mm_max_ps(nDot, zero), settings.normalPower);
+				__m128 w = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(KERNEL[dx + 2] * KERNEL[dy + 2]), wn), exp_sse(_mm_sub_ps(zero, _mm_add_ps(wz, wl))));
+				w = _mm_and_ps(w, _mm_cmpgt_ps(zq, zero));
+
+				sumW = _mm_add_ps(sumW, w);
+				sumR = _mm_add_ps(sumR, _mm_mul_ps(w, r));
+				sumG = _mm_add_ps(sumG, _mm_mul_ps(w, g));
+				sumB = _mm_add_ps(sumB, _mm_mul_ps(w, b));
+				sumVar = _mm_add_ps(sumVar, _mm_mul_ps(_mm_mul_ps(w, w), _mm_loadu_ps(srcVar + q)));
+			}
+		}
+
+		//background keeps its value, the center tap alone keeps sumW of covered pixels above zero
+		__m128 covered = _mm_cmpgt_ps(zp, zero);
+		__m128 inv = _mm_div_ps(one, _mm_or_ps(_mm_and_ps(covered, sumW), _mm_andnot_ps(covered, one)));
+		auto select = [&](__m128 filtered, __m128 original) { return _mm_or_ps(_mm_and_ps(covered, filtered), _mm_andnot_ps(covered, original)); };
+		_mm_storeu_ps(dstR + p, select(_mm_mul_ps(sumR, inv), _mm_loadu_ps(srcR + p)));
+		_mm_storeu_ps(dstG + p, select(_mm_mul_ps(sumG, inv), _mm_loadu_ps(srcG + p)));
+		_mm_storeu_ps(dstB + p, select(_mm_mul_ps(sumB, inv), _mm_loadu_ps(srcB + p)));
+		_mm_storeu_ps(dstVar + p, select(_mm_mul_ps(sumVar, _mm_mul_ps(inv, inv)), _mm_loadu_ps(srcVar + p)));
+	}
+#endif
+
+	for (; x < width; x++)
+	{
+		size_t p = row + x;
+		f32 zp = z[p];
+		if (!(zp > 0.0f))
+		{
+			dstR[p] = srcR[p];
+			dstG[p] = srcG[p];
+			dstB[p] = srcB[p];
+			dstVar[p] = srcVar[p];
+			continue;
+		}
+		f32 depthScale = settings.sigmaDepth * step * gradient[p];
+		f32 lp = luminance(vec3<f32>(srcR[p], srcG[p], srcB[p]));
+		f32 luminanceScale = settings.sigmaLuminance * sigma[p] + EPSILON;
+
+		f32 sumW = 0.0f, sumVar = 0.0f;
+		vec3<f32> sum;
+		for (i32 dy = -2; dy <= 2; dy++)
+		{
+			i32 yq = y + dy * step;
+			if (yq < 0 || yq >= height)
+				continue;
+			for (i32 dx = -2; dx <= 2; dx++)
+			{
+				size_t q = size_t(yq) * stride + pad + x + dx * step;
+				if (!(z[q] > 0.0f))
+					continue;
+				vec3<f32> c(srcR[q], srcG[q], srcB[q]);
+				f32 wz = fabsf(zp - z[q]) / (depthScale * f32(abs(dx) + abs(dy)) + EPSILON);
+				f32 wl = fabsf(lp - luminance(c)) / luminanceScale;
+				f32 wn = pow_int(max(nx[p] * nx[q] + ny[p] * ny[q] + nz[p] * nz[q], 0.0f), settings.normalPower);
+				f32 w = KERNEL[dx + 2] * KERNEL[dy + 2] * wn * expf(-(wz + wl));
+				sumW += w;
+				sum += c * w;
+				sumVar += w * w * srcVar[q];
+			}
+		}
+		dstR[p] = sum.x / sumW;
+		dstG[p] = sum.y / sumW;
+		dstB[p] = sum.z / sumW;
+		dstVar[p] = sumVar / (sumW * sumW);
+	}
+}
+
+void Denoiser::remodulateRow(const AovBuffers& aovs, int src, i32 y, f32* out)
+{
+	const f32* beauty = aovs.plane(Aov::Beauty);
+	const f32* albedo = aovs.plane(Aov::Albedo);
+	for (i32 x = 0; x < width; x++)
+	{
+		size_t i = size_t(y) * width + x;
+		size_t p = size_t(y) * stride + pad + x;
+		if (!(depth[p] > 0.0f))
+		{
+			for (int c = 0; c < 3; c++)
+				out[i * 3 + c] = beauty[i * 3 + c];
+			continue;
+		}
+		vec3<f32> factor = demodulation(albedo + i * 3);
+		for (int c = 0; c < 3; c++)
+			out[i * 3 + c] = color[src][c][p] * factor[c];
+	}
+}
+
+void Denoiser::apply(const AovBuffers& aovs, f32* out, const DenoiseSettings& settings, bool parallel)
+{
+	const f32* beauty = aovs.plane(Aov::Beauty);
+	if (!beauty)
+		return;
+
+	if (settings.iterations <= 0 || (aovs.mask & denoise_aovs()) != denoise_aovs())
+	{
+		std::copy(beauty, beauty + size_t(aovs.width) * aovs.height * 3, out);
+		return;
+	}
+
+	resize(aovs.width, aovs.height, settings.iterations);
+	for_rows(height, parallel, [&](i32 y) { prepareRow(aovs, y); });
+
+	int src = 0;
+	for (int i = 0; i < settings.iterations; i++)
+	{
+		for_rows(height, parallel, [&](i32 y) { blurVarianceRow(src, y); });
+		for_rows(height, parallel, [&](i32 y) { filterRow(src, y, 1 << i, settings); });
+		src = 1 - src;
+	}
+
+	for_rows(height, parallel, [&](i32 y) { remodulateRow(aovs, src, y, out); });
+}
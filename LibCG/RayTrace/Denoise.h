@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include "Aov.h"
+
+struct DenoiseSettings
+{
+	//a-trous passes, pass i reads taps 2^i pixels apart, 5 covers a 125 pixel footprint
+	int iterations = 5;
+	//luminance edge stop, in standard deviations of the local noise
+	f32 sigmaLuminance = 4.0f;
+	//exponent of the normal similarity max(0, dot(n, n'))
+	u32 normalPower = 128;
+	//depth edge stop, in units of the depth gradient along the tap offset
+	f32 sigmaDepth = 1.0f;
+};
+
+//planes Denoiser::apply reads
+inline u32 denoise_aovs()
+{
+	return aov_bit(Aov::Beauty) | aov_bit(Aov::Albedo) | aov_bit(Aov::Normal) | aov_bit(Aov::Depth) | aov_bit(Aov::Variance);
+}
+
+/**
+* Edge-aware a-trous wavelet filter of the beauty plane, the spatial part of SVGF.
+* Taps are weighted by normal, depth and luminance similarity, the luminance edge stop scales with
+* the Variance plane so converged pixels are left alone. Albedo is divided out before filtering and
+* multiplied back after, texture detail stays sharp. Background pixels are passed through.
+* Rows are split over the tile workers when parallel, 4 pixels of a row are filtered at a time with SSE2.
+* Working planes are kept between calls, one Denoiser per thread.
+*/
+struct Denoiser
+{
+	/**
+	* @param out width * height rgb floats, falls back to a copy of beauty when a guide plane is missing
+	*/
+	void apply(const AovBuffers& aovs, f32* out, const DenoiseSettings& settings, bool parallel = true);
+
+private:
+	//padded rows, taps of the widest pass never leave the row
+	i32 width = 0;
+	i32 height = 0;
+	i32 pad = 0;
+	i32 stride = 0;
+	//demodulated illumination and its variance, ping-ponged between passes
+	std::vector<f32> color[2][3];
+	std::vector<f32> variance[2];
+	//standard deviation of the 3x3 blurred variance
+	std::vector<f32> sigma;
+	std::vector<f32> normal[3];
+	//0 marks background and padding
+	std::vector<f32> depth;
+	std::vector<f32> gradient;
+
+	void resize(i32 width, i32 height, int iterations);
+	void prepareRow(const AovBuffers& aovs, i32 y);
+	void blurVarianceRow(int src, i32 y);
+	void filterRow(int src, i32 y, i32 step, const DenoiseSettings& settings);
+	void remodulateRow(const AovBuffers& aovs, int src, i32 y, f32* out);
+};
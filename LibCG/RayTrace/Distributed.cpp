@@ -0,0 +1,357 @@
+#include "Distributed.h"
+#include "ProgressReporter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+using namespace RayTracer;
+
+namespace
+{
+	//messages are fixed layout structs in host byte order, coordinator and workers run the same build
+	const u32 PROTOCOL_VERSION = 4;
+
+	//rows per band, a multiple of the tile size
+	const i32 BAND_ROWS = 32;
+
+	enum struct MessageType : u32
+	{
+		Job = 1,
+		Region,
+		Result,
+		Quit
+	};
+
+	//frame settings, sent once per render before its regions
+	struct JobMessage
+	{
+		u32 version = PROTOCOL_VERSION;
+		i32 width = 0;
+		i32 height = 0;
+		u32 aovMask = 0;
+		u64 primitiveCount = 0;
+		i32 environmentWidth = 0;
+		i32 environmentHeight = 0;
+		u64 environmentHash = 0;
+		Param param;
+		u32 integrator = 0;
+		i32 samplesPerPixel = 0;
+		i32 maxDepth = 0;
+		u32 nextEventEstimation = 0;
+		i32 russianRouletteDepth = 0;
+		u32 adaptiveSampling = 0;
+		f32 adaptiveThreshold = 0.0f;
+		i32 adaptiveMinSamples = 0;
+		i32 adaptiveMaxSamples = 0;
+		f32 voxelLodBounceSpread = 0.0f;
+		u32 samplerType = 0;
+	};
+
+	//followed by the planes of the job aovMask in Aov order, region pixels each
+	struct ResultMessage
+	{
+		Tile region;
+		u64 samples = 0;
+		u64 rays = 0;
+		TraversalStats traversal;
+	};
+
+	template<typename T>
+	bool send(RenderChannel& channel, MessageType type, const T& message)
+	{
+		return channel.write(&type, sizeof(type)) && channel.write(&message, sizeof(message));
+	}
+
+	JobMessage current_job(i32 width, i32 height, u32 aovMask)
+	{
+		JobMessage job;
+		job.width = width;
+		job.height = height;
+		job.aovMask = aovMask;
+		job.primitiveCount = bvhScene.primitives.size();
+		job.environmentWidth = environmentMap.width;
+		job.environmentHeight = environmentMap.height;
+		job.environmentHash = environmentMap.hash;
+		job.param = camera_param();
+		job.integrator = u32(integrator);
+		job.samplesPerPixel = samplesPerPixel;
+		job.maxDepth = maxDepth;
+		job.nextEventEstimation = nextEventEstimation;
+		job.russianRouletteDepth = russianRouletteDepth;
+		job.adaptiveSampling = adaptiveSampling;
+		job.adaptiveThreshold = adaptiveThreshold;
+		job.adaptiveMinSamples = adaptiveMinSamples;
+		job.adaptiveMaxSamples = adaptiveMaxSamples;
+		job.voxelLodBounceSpread = voxelLodBounceSpread;
+		job.samplerType = u32(samplerType);
+		return job;
+	}
+
+	void apply_job(const JobMessage& job)
+	{
+		integrator = Integrator(job.integrator);
+		samplesPerPixel = job.samplesPerPixel;
+		maxDepth = job.maxDepth;
+		nextEventEstimation = job.nextEventEstimation != 0;
+		russianRouletteDepth = job.russianRouletteDepth;
+		adaptiveSampling = job.adaptiveSampling != 0;
+		adaptiveThreshold = job.adaptiveThreshold;
+		adaptiveMinSamples = job.adaptiveMinSamples;
+		adaptiveMaxSamples = job.adaptiveMaxSamples;
+		voxelLodBounceSpread = job.voxelLodBounceSpread;
+		samplerType = SamplerType(job.samplerType);
+	}
+
+	//copy the rows of a region result into the frame planes
+	void merge_region(AovBuffers& frame, const AovBuffers& result, const Tile& region)
+	{
+		i32 regionWidth = region.x1 - region.x0;
+		for (u32 a = 0; a < u32(Aov::Count); a++)
+		{
+			if (!frame.has(Aov(a)))
+				continue;
+			u32 n = AovBuffers::channels(Aov(a));
+			const f32* src = result.plane(Aov(a));
+			f32* dst = frame.plane(Aov(a));
+			for (i32 y = region.y0; y < region.y1; y++)
+			{
+				std::copy(src + size_t(y - region.y0) * regionWidth * n, src + size_t(y - region.y0 + 1) * regionWidth * n,
+					dst + (size_t(y) * frame.width + region.x0) * n);
+			}
+		}
+	}
+}
+
+#ifndef _WIN32
+FdChannel::FdChannel(int readFd, int writeFd) : readFd(readFd), writeFd(writeFd)
+{
+}
+
+FdChannel::~FdChannel()
+{
+	close(readFd);
+	if (writeFd != readFd)
+		close(writeFd);
+}
+
+bool FdChannel::read(void* data, size_t size)
+{
+	u8* p = (u8*)data;
+	while (size > 0)
+	{
+		ssize_t n = ::read(readFd, p, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		size -= size_t(n);
+	}
+	return true;
+}
+
+bool FdChannel::write(const void* data, size_t size)
+{
+	const u8* p = (const u8*)data;
+	while (size > 0)
+	{
+		ssize_t n = ::write(writeFd, p, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		size -= size_t(n);
+	}
+	return true;
+}
+#endif
+
+bool render_distributed(i32 width, i32 height, AovBuffers& aovs, const std::vector<RenderChannel*>& workers)
+{
+	aovs.resize(width, height, aovs.mask);
+	JobMessage job = current_job(width, height, aovs.mask);
+
+	std::mutex mutex;
+	std::deque<Tile> bands;
+	for (i32 y = 0; y < height; y += BAND_ROWS)
+		bands.push_back(Tile{ 0, y, width, min(y + BAND_ROWS, height) });
+
+	ProgressReporter progress(u64(width) * height, u32(workers.size()), renderProgressCallback);
+	//written by the worker's own thread only
+	std::vector<u8> failed(workers.size(), 0);
+	u64 samples = 0;
+	u64 rays = 0;
+	TraversalStats traversal;
+
+	//one coordinator thread per worker, blocking on its channel, bands are disjoint so merging needs no lock
+	auto serve = [&](u32 w)
+	{
+		RenderChannel& channel = *workers[w];
+		AovBuffers result;
+		result.mask = aovs.mask;
+		if (!send(channel, MessageType::Job, job))
+		{
+			failed[w] = 1;
+			return;
+		}
+		while (true)
+		{
+			Tile band;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (bands.empty())
+					return;
+				band = bands.front();
+				bands.pop_front();
+			}
+
+			MessageType type;
+			ResultMessage header;
+			result.resize(band.x1 - band.x0, band.y1 - band.y0, aovs.mask);
+			bool ok = send(channel, MessageType::Region, band)
+				&& channel.read(&type, sizeof(type)) && type == MessageType::Result
+				&& channel.read(&header, sizeof(header));
+			for (u32 a = 0; ok && a < u32(Aov::Count); a++)
+			{
+				if (result.has(Aov(a)))
+					ok = channel.read(result.plane(Aov(a)), result.planes[a].size() * sizeof(f32));
+			}
+			if (!ok)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				bands.push_back(band);
+				failed[w] = 1;
+				return;
+			}
+
+			merge_region(aovs, result, band);
+			progress.add(w, u64(band.x1 - band.x0) * (band.y1 - band.y0));
+			std::lock_guard<std::mutex> lock(mutex);
+			samples += header.samples;
+			rays += header.rays;
+			traversal += header.traversal;
+		}
+	};
+
+	//a failed worker puts its band back, the survivors take another round for it
+	while (true)
+	{
+		std::vector<std::thread> threads;
+		for (u32 w = 0; w < workers.size(); w++)
+		{
+			if (!failed[w])
+				threads.emplace_back(serve, w);
+		}
+		for (auto& thread : threads)
+			thread.join();
+		if (bands.empty() || threads.empty())
+			break;
+	}
+	progress.finish();
+
+	renderStats.samples = samples;
+	renderStats.rays = rays;
+	renderStats.traversal = traversal;
+	renderStats.samplesSaved = i64(u64(width) * height * samplesPerPixel) - i64(samples);
+	if (!bands.empty())
+		fprintf(stderr, "[Distributed] no worker left, %zu bands not rendered\n", bands.size());
+	return bands.empty();
+}
+
+bool render_distributed(i32 width, i32 height, u32* buffer, const std::vector<RenderChannel*>& workers)
+{
+	AovBuffers aovs;
+	aovs.mask = display_mask();
+	if (!render_distributed(width, height, aovs, workers))
+		return false;
+	display_aov(aovs, buffer);
+	return true;
+}
+
+void stop_render_workers(const std::vector<RenderChannel*>& workers)
+{
+	MessageType type = MessageType::Quit;
+	for (RenderChannel* channel : workers)
+		channel->write(&type, sizeof(type));
+}
+
+bool serve_render_worker(RenderChannel& channel, bool parallel)
+{
+	JobMessage job;
+	bool hasJob = false;
+	AovBuffers result;
+	while (true)
+	{
+		MessageType type;
+		if (!channel.read(&type, sizeof(type)))
+			return true;
+
+		switch (type)
+		{
+		case MessageType::Job:
+			if (!channel.read(&job, sizeof(job)))
+				return false;
+			if (job.version != PROTOCOL_VERSION || job.primitiveCount != bvhScene.primitives.size())
+			{
+				fprintf(stderr, "[Distributed] job of protocol %u with %llu primitives, worker has protocol %u with %zu\n",
+					job.version, (unsigned long long)job.primitiveCount, PROTOCOL_VERSION, bvhScene.primitives.size());
+				return false;
+			}
+			if (job.environmentWidth != environmentMap.width || job.environmentHeight != environmentMap.height
+				|| job.environmentHash != environmentMap.hash)
+			{
+				fprintf(stderr, "[Distributed] job lit by a %dx%d environment %016llx, worker has %dx%d %016llx\n",
+					job.environmentWidth, job.environmentHeight, (unsigned long long)job.environmentHash,
+					environmentMap.width, environmentMap.height, (unsigned long long)environmentMap.hash);
+				return false;
+			}
+			apply_job(job);
+			hasJob = true;
+			break;
+
+		case MessageType::Region:
+		{
+			ResultMessage header;
+			if (!hasJob || !channel.read(&header.region, sizeof(header.region)))
+				return false;
+			const Tile& region = header.region;
+			if (region.x0 < 0 || region.y0 < 0 || region.x1 > job.width || region.y1 > job.height || region.x0 >= region.x1 || region.y0 >= region.y1)
+				return false;
+
+			//regions are independent one-shot renders
+			bool wasProgressive = progressive;
+			progressive = false;
+			result.mask = job.aovMask;
+			render_region(job.width, job.height, region, job.param, result, parallel);
+			progressive = wasProgressive;
+
+			header.samples = renderStats.samples;
+			header.rays = renderStats.rays;
+			header.traversal = renderStats.traversal;
+			if (!send(channel, MessageType::Result, header))
+				return false;
+			for (u32 a = 0; a < u32(Aov::Count); a++)
+			{
+				if (result.has(Aov(a)) && !channel.write(result.plane(Aov(a)), result.planes[a].size() * sizeof(f32)))
+					return false;
+			}
+			break;
+		}
+
+		case MessageType::Quit:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+}
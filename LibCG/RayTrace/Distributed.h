@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include "RayTracer.h"
+
+/**
+* Ordered, reliable byte stream between the coordinator and one render worker.
+* The protocol only reads and writes whole messages through it, a pipe, a socket or an
+* in-process queue all work, so workers can live in other processes or on other machines.
+*/
+struct RenderChannel
+{
+	virtual ~RenderChannel() = default;
+
+	//blocks until size bytes arrived, false once the stream ended or failed
+	virtual bool read(void* data, size_t size) = 0;
+
+	virtual bool write(const void* data, size_t size) = 0;
+};
+
+#ifndef _WIN32
+/**
+* Pipe or socket file descriptors, both closed by the destructor (once when they are the same)
+*/
+struct FdChannel : RenderChannel
+{
+	FdChannel(int readFd, int writeFd);
+	~FdChannel() override;
+
+	FdChannel(const FdChannel&) = delete;
+	FdChannel& operator=(const FdChannel&) = delete;
+
+	bool read(void* data, size_t size) override;
+	bool write(const void* data, size_t size) override;
+
+private:
+	int readFd;
+	int writeFd;
+};
+#endif
+
+/**
+* Render a width x height frame on workers served by serve_render_worker. Bands of rows are handed
+* out one at a time, a worker gets the next band when its result is back, and the float planes of
+* aovs.mask are merged into aovs. Render settings and the camera are sent with the job, the scene
+* is not: every worker must have loaded the same scene, checked by primitive count, and the same
+* environment map, checked by its size and pixel hash.
+* Bands of a worker that fails are rendered by the others.
+* @return false when no worker is left to finish the frame
+*/
+bool render_distributed(i32 width, i32 height, AovBuffers& aovs, const std::vector<RenderChannel*>& workers);
+
+/**
+* u32 output like render(), the display planes are rendered remotely, denoiser and post process run here
+*/
+bool render_distributed(i32 width, i32 height, u32* buffer, const std::vector<RenderChannel*>& workers);
+
+/**
+* Ask the workers to return from serve_render_worker
+*/
+void stop_render_workers(const std::vector<RenderChannel*>& workers);
+
+/**
+* Worker loop, renders the regions the coordinator asks for until it stops the worker or the channel closes.
+* Render settings come with each job, threadCount stays the worker's own.
+* @return false on a protocol error or a scene that does not match the job
+*/
+bool serve_render_worker(RenderChannel& channel, bool parallel = true);
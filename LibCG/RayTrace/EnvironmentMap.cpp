@@ -0,0 +1,101 @@
+#include "EnvironmentMap.h"
+#include "../Util.h"
+
+#include <cstdio>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_HDR
+#include "stb_image.h"
+
+bool EnvironmentMap::load(const char* filename)
+{
+	clear();
+	int w, h, channels;
+	f32* data = stbi_loadf(filename, &w, &h, &channels, 3);
+	if (!data)
+	{
+		fprintf(stderr, "[Environment] can't read %s: %s\n", filename, stbi_failure_reason());
+		return false;
+	}
+
+	width = w;
+	height = h;
+	pixels.resize(size_t(w) * h);
+	std::vector<f32> weights(pixels.size());
+	for (i32 y = 0; y < h; y++)
+	{
+		f32 sinTheta = sinf((f32(y) + 0.5f) / f32(h) * F32_PI);
+		for (i32 x = 0; x < w; x++)
+		{
+			size_t i = size_t(y) * w + x;
+			pixels[i] = vec3<f32>(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
+			weights[i] = max(luminance(pixels[i]), 0.0f) * sinTheta;
+		}
+	}
+	stbi_image_free(data);
+
+	//FNV-1a over the 32 bit words of the pixels
+	hash = 0xcbf29ce484222325ull;
+	const u32* words = reinterpret_cast<const u32*>(pixels.data());
+	for (size_t i = 0; i < pixels.size() * 3; i++)
+		hash = (hash ^ words[i]) * 0x100000001b3ull;
+
+	//an all black map lights nothing, BSDF sampling alone sees it
+	table.build(weights);
+	return true;
+}
+
+void EnvironmentMap::clear()
+{
+	width = 0;
+	height = 0;
+	pixels.clear();
+	hash = 0;
+	table = AliasTable();
+}
+
+u32 EnvironmentMap::pixelOf(const vec3<f32>& direction, f32& sinTheta) const
+{
+	f32 cosTheta = min(max(direction.y, -1.0f), 1.0f);
+	sinTheta = sqrtf(max(0.0f, 1.0f - cosTheta * cosTheta));
+	f32 u = (atan2f(direction.z, direction.x) + F32_PI) * (0.5f * F32_1_FRAC_PI);
+	f32 v = acosf(cosTheta) * F32_1_FRAC_PI;
+	i32 x = min(max(i32(u * width), 0), width - 1);
+	i32 y = min(max(i32(v * height), 0), height - 1);
+	return u32(y * width + x);
+}
+
+vec3<f32> EnvironmentMap::radiance(const vec3<f32>& direction) const
+{
+	f32 sinTheta;
+	return pixels[pixelOf(direction, sinTheta)];
+}
+
+vec3<f32> EnvironmentMap::sample(const vec2<f32>& u, const vec2<f32>& jitter, vec3<f32>& direction, f32& pdf) const
+{
+	pdf = 0.0f;
+	if (table.empty())
+		return vec3<f32>(0.0f);
+
+	u32 i = table.sample(u);
+	f32 phi = (f32(i % width) + jitter.x) / f32(width) * F32_2PI - F32_PI;
+	f32 theta = (f32(i / width) + jitter.y) / f32(height) * F32_PI;
+	f32 sinTheta = sinf(theta);
+	if (sinTheta <= 0.0f)
+		return vec3<f32>(0.0f);
+	direction = vec3<f32>(sinTheta * cosf(phi), cosf(theta), sinTheta * sinf(phi));
+	//uniform inside the pixel in (u, v), the map covers 2pi * pi of (phi, theta)
+	pdf = table.pmf[i] * f32(width) * f32(height) / (2.0f * F32_PI * F32_PI * sinTheta);
+	return pixels[i];
+}
+
+f32 EnvironmentMap::pdf(const vec3<f32>& direction) const
+{
+	if (table.empty())
+		return 0.0f;
+	f32 sinTheta;
+	u32 i = pixelOf(direction, sinTheta);
+	if (sinTheta <= 0.0f)
+		return 0.0f;
+	return table.pmf[i] * f32(width) * f32(height) / (2.0f * F32_PI * F32_PI * sinTheta);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include "../KDMath.h"
+#include "Sampling.h"
+
+/**
+* Equirectangular HDR environment at infinity, +y up. Row 0 is straight up, column 0 faces -x and
+* u grows toward +z. Pixels are picked for light samples by an alias table over luminance * sin(theta),
+* the sin(theta) undoes the squeeze of rows toward the poles.
+*/
+struct EnvironmentMap
+{
+	i32 width = 0;
+	i32 height = 0;
+	std::vector<vec3<f32>> pixels;
+	AliasTable table;
+	//of the pixels, tells checkpoints and render workers whether they saw the same map, 0 when empty
+	u64 hash = 0;
+
+	//.hdr or any float image stb_image reads, false leaves the map empty
+	bool load(const char* filename);
+
+	void clear();
+
+	bool empty() const { return pixels.empty(); }
+
+	//radiance arriving from direction, the pixel it points at
+	vec3<f32> radiance(const vec3<f32>& direction) const;
+
+	/**
+	* Direction toward the environment, importance sampled
+	* @param u picks the pixel, see AliasTable::sample, jitter the point inside it
+	* @return radiance along direction, pdf is per solid angle
+	*/
+	vec3<f32> sample(const vec2<f32>& u, const vec2<f32>& jitter, vec3<f32>& direction, f32& pdf) const;
+
+	//solid angle pdf of sample() returning direction
+	f32 pdf(const vec3<f32>& direction) const;
+
+private:
+	//pixel of a direction, sin(theta) of the direction for the pdf
+	u32 pixelOf(const vec3<f32>& direction, f32& sinTheta) const;
+};
@@ -0,0 +1,59 @@
+#include "Light.h"
+#include "../Util.h"
+#include <algorithm>
+
+void LightList::build(const std::vector<Primitive*>& primitives)
+{
+	lights.clear();
+	cdf.clear();
+	totalPower = 0.0f;
+
+	for (auto& prim : primitives)
+	{
+		prim->lightIndex = -1;
+		f32 power = prim->area() * luminance(prim->material.emissive);
+		if (power <= 0.0f)
+			continue;
+
+		prim->lightIndex = (i32)lights.size();
+		lights.push_back(prim);
+		totalPower += power;
+		cdf.push_back(totalPower);
+	}
+
+	for (auto& c : cdf)
+		c /= totalPower;
+	if (!cdf.empty())
+		cdf.back() = 1.0f;
+
+	bvh.build(lights);
+}
+
+const Primitive* LightList::sample(f32 u, const vec3<f32>& P, const vec3<f32>& N, f32& pmf) const
+{
+	if (lights.empty())
+	{
+		pmf = 0.0f;
+		return nullptr;
+	}
+
+	if (sampling == LightSampling::Bvh)
+		return bvh.sample(lights, u, P, N, pmf);
+
+	size_t index = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+	index = min(index, lights.size() - 1);
+	pmf = cdf[index] - (index > 0 ? cdf[index - 1] : 0.0f);
+	return lights[index];
+}
+
+f32 LightList::pmf(const Primitive* light, const vec3<f32>& P, const vec3<f32>& N) const
+{
+	if (!light || light->lightIndex < 0 || light->lightIndex >= (i32)lights.size() || lights[light->lightIndex] != light)
+		return 0.0f;
+
+	if (sampling == LightSampling::Bvh)
+		return bvh.pmf((u32)light->lightIndex, P, N);
+
+	size_t index = light->lightIndex;
+	return cdf[index] - (index > 0 ? cdf[index - 1] : 0.0f);
+}
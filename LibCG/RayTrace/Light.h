@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "Primitive.h"
+#include "LightBvh.h"
+
+enum struct LightSampling
+{
+	//proportional to power, ignores the shading point
+	Power,
+	//light BVH, importance to the shading point
+	Bvh
+};
+
+/**
+* Emissive primitives of a scene, power is area * emitted luminance.
+*/
+struct LightList
+{
+	LightSampling sampling = LightSampling::Bvh;
+	std::vector<Primitive*> lights;
+	//normalized, cdf.back() == 1
+	std::vector<f32> cdf;
+	f32 totalPower = 0.0f;
+	LightBvh bvh;
+
+	//collects emitters and assigns Primitive::lightIndex
+	void build(const std::vector<Primitive*>& primitives);
+
+	bool empty() const { return lights.empty(); }
+
+	//P and N are the shading point and normal, only the BVH looks at them
+	const Primitive* sample(f32 u, const vec3<f32>& P, const vec3<f32>& N, f32& pmf) const;
+
+	//probability of picking light from P, 0 if it is not in the list
+	f32 pmf(const Primitive* light, const vec3<f32>& P, const vec3<f32>& N) const;
+};
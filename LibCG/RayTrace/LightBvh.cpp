@@ -0,0 +1,194 @@
+#include "LightBvh.h"
+#include "../Util.h"
+#include <algorithm>
+
+static const f32 HALF_PI = 0.5f * F32_PI;
+
+//union of two normal line cones, the result covers both
+static void merge_cone(vec3<f32> axisA, f32 angleA, vec3<f32> axisB, f32 angleB, vec3<f32>& axis, f32& angle)
+{
+	//lines, flip b to the same side as a
+	if (dot(axisA, axisB) < 0.0f)
+		axisB = axisB * -1.0f;
+	if (angleA < angleB)
+	{
+		std::swap(axisA, axisB);
+		std::swap(angleA, angleB);
+	}
+
+	f32 angleD = acosf(min(max(dot(axisA, axisB), -1.0f), 1.0f));
+	if (min(angleD + angleB, F32_PI) <= angleA)
+	{
+		axis = axisA;
+		angle = angleA;
+		return;
+	}
+
+	angle = 0.5f * (angleA + angleD + angleB);
+	if (angle >= HALF_PI)
+	{
+		axis = axisA;
+		angle = HALF_PI;
+		return;
+	}
+
+	//rotate a towards b
+	f32 rotate = angle - angleA;
+	axis = normalize(axisA * sinf(angleD - rotate) + axisB * sinf(rotate));
+}
+
+void LightBvh::build(const std::vector<Primitive*>& lights)
+{
+	nodes.clear();
+	lightNodes.assign(lights.size(), 0);
+	if (lights.empty())
+		return;
+
+	std::vector<u32> order(lights.size());
+	for (u32 i = 0; i < order.size(); i++)
+		order[i] = i;
+
+	nodes.reserve(lights.size() * 2 - 1);
+	buildRecursive(lights, order, 0, order.size(), -1);
+}
+
+u32 LightBvh::buildRecursive(const std::vector<Primitive*>& lights, std::vector<u32>& order, size_t start, size_t end, i32 parent)
+{
+	u32 index = (u32)nodes.size();
+	nodes.emplace_back();
+	nodes[index].parent = parent;
+
+	if (end - start == 1)
+	{
+		const Primitive* light = lights[order[start]];
+		LightBvhNode& node = nodes[index];
+		node.bounds = light->aabb;
+		node.halfAngle = light->normalBounds(node.axis);
+		node.power = light->area() * luminance(light->material.emissive);
+		node.light = (i32)order[start];
+		lightNodes[order[start]] = index;
+		return index;
+	}
+
+	//median split along the widest centroid extent, keeps the tree balanced
+	vec3<f32> cmin(F32_MAX), cmax(-F32_MAX);
+	for (size_t i = start; i < end; i++)
+	{
+		vec3<f32> c = (lights[order[i]]->aabb.min + lights[order[i]]->aabb.max) * 0.5f;
+		cmin = min(cmin, c);
+		cmax = max(cmax, c);
+	}
+	vec3<f32> extent = cmax - cmin;
+	int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+	size_t mid = start + (end - start) / 2;
+	std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end, [&](u32 a, u32 b)
+		{
+			return lights[a]->aabb.min[axis] + lights[a]->aabb.max[axis] < lights[b]->aabb.min[axis] + lights[b]->aabb.max[axis];
+		});
+
+	u32 left = buildRecursive(lights, order, start, mid, (i32)index);
+	u32 right = buildRecursive(lights, order, mid, end, (i32)index);
+
+	//nodes may have grown, take references after the children exist
+	const LightBvhNode& l = nodes[left];
+	const LightBvhNode& r = nodes[right];
+	LightBvhNode& node = nodes[index];
+	node.rightChild = right;
+	node.bounds.min = min(l.bounds.min, r.bounds.min);
+	node.bounds.max = max(l.bounds.max, r.bounds.max);
+	node.power = l.power + r.power;
+	merge_cone(l.axis, l.halfAngle, r.axis, r.halfAngle, node.axis, node.halfAngle);
+	return index;
+}
+
+/**
+* Upper bound style estimate: power / d^2, times the best emitter and receiver cosines
+* any point inside the bounds could reach.
+*/
+f32 LightBvh::importance(const LightBvhNode& node, const vec3<f32>& P, const vec3<f32>& N) const
+{
+	vec3<f32> center = (node.bounds.min + node.bounds.max) * 0.5f;
+	f32 radius = 0.5f * length(node.bounds.max - node.bounds.min);
+	vec3<f32> d = P - center;
+	f32 dist2 = dot(d, d);
+
+	//inside the bounding sphere every direction is possible
+	if (dist2 <= radius * radius)
+		return node.power / max(radius * radius, 1e-8f);
+
+	f32 dist = sqrtf(dist2);
+	vec3<f32> w = d / dist;
+	f32 angleU = asinf(min(radius / dist, 1.0f));
+
+	//angle between w and the nearest normal line of the cone
+	f32 angle = acosf(min(fabsf(dot(node.axis, w)), 1.0f));
+	f32 angleEmit = max(angle - node.halfAngle - angleU, 0.0f);
+	if (angleEmit >= HALF_PI)
+		return 0.0f;
+
+	f32 angleReceive = max(acosf(min(max(-dot(N, w), -1.0f), 1.0f)) - angleU, 0.0f);
+	if (angleReceive >= HALF_PI)
+		return 0.0f;
+
+	return node.power * cosf(angleEmit) * cosf(angleReceive) / dist2;
+}
+
+const Primitive* LightBvh::sample(const std::vector<Primitive*>& lights, f32 u, const vec3<f32>& P, const vec3<f32>& N, f32& pmf) const
+{
+	pmf = 0.0f;
+	if (nodes.empty())
+		return nullptr;
+
+	f32 p = 1.0f;
+	u32 index = 0;
+	while (nodes[index].light < 0)
+	{
+		u32 left = index + 1;
+		u32 right = nodes[index].rightChild;
+		f32 importanceLeft = importance(nodes[left], P, N);
+		f32 importanceRight = importance(nodes[right], P, N);
+		if (importanceLeft + importanceRight <= 0.0f)
+			return nullptr;
+
+		//reuse u, rescaled into the picked interval
+		f32 pLeft = importanceLeft / (importanceLeft + importanceRight);
+		if (u < pLeft)
+		{
+			u = min(u / pLeft, 0.99999994f);
+			p *= pLeft;
+			index = left;
+		}
+		else
+		{
+			u = min((u - pLeft) / (1.0f - pLeft), 0.99999994f);
+			p *= 1.0f - pLeft;
+			index = right;
+		}
+	}
+
+	pmf = p;
+	return lights[nodes[index].light];
+}
+
+f32 LightBvh::pmf(u32 lightIndex, const vec3<f32>& P, const vec3<f32>& N) const
+{
+	if (lightIndex >= lightNodes.size())
+		return 0.0f;
+
+	//same choices as sample, walked from the leaf up
+	f32 p = 1.0f;
+	u32 index = lightNodes[lightIndex];
+	while (nodes[index].parent >= 0)
+	{
+		u32 parent = (u32)nodes[index].parent;
+		u32 sibling = index == parent + 1 ? nodes[parent].rightChild : parent + 1;
+		f32 importanceSelf = importance(nodes[index], P, N);
+		f32 importanceSibling = importance(nodes[sibling], P, N);
+		if (importanceSelf <= 0.0f)
+			return 0.0f;
+		p *= importanceSelf / (importanceSelf + importanceSibling);
+		index = parent;
+	}
+	return p;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include "Primitive.h"
+
+/**
+* Node bounds of a light BVH: space, power and a cone around the emitter normals.
+* Emitters are two-sided, so the cone bounds normal lines, halfAngle = pi/2 covers every direction.
+*/
+struct LightBvhNode
+{
+	aabb bounds;
+	vec3<f32> axis{ 0.0f, 1.0f, 0.0f };
+	f32 halfAngle = 0.0f;
+	f32 power = 0.0f;
+	//inner: index of the right child, the left one follows this node
+	u32 rightChild = 0;
+	//leaf: index in lights, -1 for inner nodes
+	i32 light = -1;
+	i32 parent = -1;
+};
+
+/**
+* Importance-driven light picking in O(log n), each inner node splits u between its children
+* by the estimated contribution of their bounds to the shading point.
+*/
+struct LightBvh
+{
+	std::vector<LightBvhNode> nodes;
+	//leaf node of each light
+	std::vector<u32> lightNodes;
+
+	void build(const std::vector<Primitive*>& lights);
+
+	const Primitive* sample(const std::vector<Primitive*>& lights, f32 u, const vec3<f32>& P, const vec3<f32>& N, f32& pmf) const;
+
+	f32 pmf(u32 lightIndex, const vec3<f32>& P, const vec3<f32>& N) const;
+
+private:
+	u32 buildRecursive(const std::vector<Primitive*>& lights, std::vector<u32>& order, size_t start, size_t end, i32 parent);
+	f32 importance(const LightBvhNode& node, const vec3<f32>& P, const vec3<f32>& N) const;
+};
@@ -0,0 +1,115 @@
+#include "PostProcess.h"
+#include "../ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POST_PROCESS_SSE2
+#include <emmintrin.h>
+#endif
+
+//linear [0, 1] quantized to LUT_SIZE steps, fine enough that sRGB dark values round like the exact curve
+static const u32 LUT_BITS = 12;
+static const u32 LUT_SIZE = 1u << LUT_BITS;
+
+static const i32 ROWS_PER_TASK = 16;
+
+struct EncodeLut
+{
+	u8 srgb[LUT_SIZE];
+	u8 linear[LUT_SIZE];
+
+	EncodeLut()
+	{
+		for (u32 i = 0; i < LUT_SIZE; i++)
+		{
+			f32 v = f32(i) / f32(LUT_SIZE - 1);
+			f32 s = v <= 0.0031308f ? 12.92f * v : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f;
+			srgb[i] = u8(min(max(s, 0.0f), 1.0f) * 255.0f + 0.5f);
+			linear[i] = u8(v * 255.0f + 0.5f);
+		}
+	}
+};
+
+static const EncodeLut ENCODE_LUT;
+
+static inline f32 tonemap_scalar(f32 x, Tonemap tonemap)
+{
+	x = max(x, 0.0f);
+	if (tonemap == Tonemap::Reinhard)
+		x = x / (1.0f + x);
+	else if (tonemap == Tonemap::Aces)
+		x = (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+	return min(x, 1.0f);
+}
+
+#ifdef POST_PROCESS_SSE2
+static inline __m128 tonemap_sse(__m128 x, Tonemap tonemap)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	x = _mm_max_ps(x, zero);
+	if (tonemap == Tonemap::Reinhard)
+	{
+		x = _mm_div_ps(x, _mm_add_ps(one, x));
+	}
+	else if (tonemap == Tonemap::Aces)
+	{
+		__m128 num = _mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.51f), x), _mm_set1_ps(0.03f)));
+		__m128 den = _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.43f), x), _mm_set1_ps(0.59f))), _mm_set1_ps(0.14f));
+		x = _mm_div_ps(num, den);
+	}
+	return _mm_min_ps(x, one);
+}
+#endif
+
+static void tonemap_span(const f32* rgb, u32* out, i32 count, f32 scale, const PostProcessSettings& settings)
+{
+	const u8* lut = settings.srgb ? ENCODE_LUT.srgb : ENCODE_LUT.linear;
+	const f32 lutScale = f32(LUT_SIZE - 1);
+	i32 i = 0;
+
+#ifdef POST_PROCESS_SSE2
+	//4 pixels = 12 floats = 3 registers, channels are independent so the interleaving doesn't matter
+	const __m128 exposure = _mm_set1_ps(scale);
+	const __m128 toIndex = _mm_set1_ps(lutScale);
+	const __m128 half = _mm_set1_ps(0.5f);
+	alignas(16) i32 index[12];
+	for (; i + 4 <= count; i += 4)
+	{
+		const f32* p = rgb + i * 3;
+		for (int k = 0; k < 3; k++)
+		{
+			__m128 v = _mm_mul_ps(_mm_loadu_ps(p + k * 4), exposure);
+			v = tonemap_sse(v, settings.tonemap);
+			_mm_store_si128((__m128i*)(index + k * 4), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, toIndex), half)));
+		}
+		for (int k = 0; k < 4; k++)
+			out[i + k] = (u32(lut[index[k * 3]]) << 16) | (u32(lut[index[k * 3 + 1]]) << 8) | u32(lut[index[k * 3 + 2]]);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		u32 c[3];
+		for (int k = 0; k < 3; k++)
+			c[k] = lut[u32(tonemap_scalar(rgb[i * 3 + k] * scale, settings.tonemap) * lutScale + 0.5f)];
+		out[i] = (c[0] << 16) | (c[1] << 8) | c[2];
+	}
+}
+
+void tonemap_rgb(const f32* rgb, i32 width, i32 height, u32* out, const PostProcessSettings& settings, bool parallel)
+{
+	f32 scale = exp2f(settings.exposure);
+
+	if (!parallel)
+	{
+		tonemap_span(rgb, out, width * height, scale, settings);
+		return;
+	}
+
+	//bands of full rows, long contiguous spans for the SIMD loop
+	parallel_for(u32(height), ROWS_PER_TASK, [&](u32 begin, u32 end)
+		{
+			size_t offset = size_t(begin) * width;
+			tonemap_span(rgb + offset * 3, out + offset, i32(end - begin) * width, scale, settings);
+		});
+}
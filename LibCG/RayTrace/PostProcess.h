@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../KDMath.h"
+
+enum struct Tonemap
+{
+	//clamp to [0, 1]
+	None,
+	Reinhard,
+	//Narkowicz ACES filmic fit
+	Aces
+};
+
+struct PostProcessSettings
+{
+	//stops, radiance is scaled by 2^exposure
+	f32 exposure = 0.0f;
+	Tonemap tonemap = Tonemap::Aces;
+	//sRGB transfer curve, linear quantization otherwise
+	bool srgb = true;
+};
+
+/**
+* HDR float rgb (3 floats per pixel) to packed 0x00RRGGBB like rgb2hex.
+* Exposure, tonemap and clamp run 4 floats at a time with SSE2, encoding and 8 bit quantization through a lookup table.
+* Rows are split over the tile workers when parallel.
+*/
+void tonemap_rgb(const f32* rgb, i32 width, i32 height, u32* out, const PostProcessSettings& settings, bool parallel = true);
@@ -12,6 +12,38 @@ bool PrimitiveAabox::rayIntersect(const ray& ray, HitInfo& hitInfo)
 	return hitInfo.t < F32_INF;
 }
 
+f32 PrimitiveAabox::area() const
+{
+	vec3<f32> e = aabb.max - aabb.min;
+	return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+void PrimitiveAabox::samplePoint(f32 u1, f32 u2, vec3<f32>& p, vec3<f32>& n) const
+{
+	//pick a face pair by area, then the side, reusing u1
+	vec3<f32> e = aabb.max - aabb.min;
+	f32 faceArea[3] = { e.y * e.z, e.z * e.x, e.x * e.y };
+	f32 total = faceArea[0] + faceArea[1] + faceArea[2];
+	f32 u = u1 * total;
+	int axis = 0;
+	while (axis < 2 && u >= faceArea[axis])
+	{
+		u -= faceArea[axis];
+		axis++;
+	}
+	u = faceArea[axis] > 0.0f ? min(u / faceArea[axis], 0.99999994f) : 0.0f;
+	bool maxSide = u >= 0.5f;
+	u = maxSide ? u * 2.0f - 1.0f : u * 2.0f;
+
+	int a1 = (axis + 1) % 3;
+	int a2 = (axis + 2) % 3;
+	p[axis] = maxSide ? aabb.max[axis] : aabb.min[axis];
+	p[a1] = aabb.min[a1] + u * e[a1];
+	p[a2] = aabb.min[a2] + u2 * e[a2];
+	n = vec3<f32>(0.0f);
+	n[axis] = maxSide ? 1.0f : -1.0f;
+}
+
 void PrimitiveSphere::updateAabb()
 {
 	auto rv = vec3<f32>(radius, radius, radius);
@@ -26,6 +58,20 @@ bool PrimitiveSphere::rayIntersect(const ray& ray, HitInfo& hitInfo)
 	return hitInfo.t < F32_INF;
 }
 
+f32 PrimitiveSphere::area() const
+{
+	return 4.0f * F32_PI * radius * radius;
+}
+
+void PrimitiveSphere::samplePoint(f32 u1, f32 u2, vec3<f32>& p, vec3<f32>& n) const
+{
+	f32 z = 1.0f - 2.0f * u1;
+	f32 r = sqrtf(fmaxf(0.0f, 1.0f - z * z));
+	f32 phi = F32_2PI * u2;
+	n = vec3<f32>(r * cosf(phi), r * sinf(phi), z);
+	p = center + n * radius;
+}
+
 void PrimitiveTriangle::updateAabb()
 {
 	aabb.min = min(vertex[0], min(vertex[1], vertex[2]));
@@ -38,3 +84,41 @@ bool PrimitiveTriangle::rayIntersect(const ray& ray, HitInfo& hitInfo)
 	ray_triangle_intersect(vertex[0], vertex[1], vertex[2], ray, hitInfo.t, hitInfo.bary, hitInfo.normal);
 	return hitInfo.t < F32_INF;
 }
+
+f32 PrimitiveTriangle::area() const
+{
+	return 0.5f * length(cross(vertex[1] - vertex[0], vertex[2] - vertex[0]));
+}
+
+void PrimitiveTriangle::samplePoint(f32 u1, f32 u2, vec3<f32>& p, vec3<f32>& n) const
+{
+	f32 su = sqrtf(u1);
+	f32 b0 = 1.0f - su;
+	f32 b1 = u2 * su;
+	p = vertex[0] * b0 + vertex[1] * b1 + vertex[2] * (1.0f - b0 - b1);
+	n = normalize(cross(vertex[1] - vertex[0], vertex[2] - vertex[0]));
+}
+
+f32 PrimitiveTriangle::normalBounds(vec3<f32>& axis) const
+{
+	axis = normalize(cross(vertex[1] - vertex[0], vertex[2] - vertex[0]));
+	return 0.0f;
+}
+
+void PrimitiveVoxelTree::updateAabb()
+{
+	f32 size = f32(1ull << (2 * tree.levels));
+	aabb.min = tree.origin;
+	aabb.max = tree.origin + vec3<f32>(size);
+}
+
+bool PrimitiveVoxelTree::rayIntersect(const ray& ray, HitInfo& hitInfo)
+{
+	vec3<f32> color;
+	if (!tree.rayIntersect(ray, hitInfo.t, hitInfo.normal, color, lod))
+		return false;
+
+	hitInfo.material = material;
+	hitInfo.material.color = color;
+	return true;
+}
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "../KDMath.h"
+#include "VoxelTree.h"
 
 enum struct MaterialType
 {
@@ -17,29 +18,48 @@ struct Material
 	vec3<f32> emissive;
 	f32 metallic = 0.0f;
 	f32 roughness = 0.1f;
+	//Glass refraction, Disney dielectric specular
+	f32 ior = 1.5f;
 };
 
+struct Primitive;
+
 struct HitInfo
 {
 	f32 t = F32_INF;
 	vec3<f32> bary;
 	vec3<f32> normal;
 	Material material;
+	Primitive* primitive = nullptr;
 };
 
 struct Primitive
 {
-	aabb aabb;
+	::aabb aabb;
 	Material material;
+	//stable per scene, assigned in load order by BVHAccel::build
+	i32 id = -1;
+	//index in the scene light list, -1 = not an emitter
+	i32 lightIndex = -1;
+
+	virtual ~Primitive() = default;
 
 	virtual void updateAabb() = 0;
 	virtual bool rayIntersect(const ray& ray, HitInfo& hitInfo) = 0;
+
+	//area light sampling, primitives without area can't be sampled as lights
+	virtual f32 area() const { return 0.0f; }
+	virtual void samplePoint(f32 /*u1*/, f32 /*u2*/, vec3<f32>& /*p*/, vec3<f32>& /*n*/) const {}
+	//half angle of a cone around axis holding the surface normal lines, pi/2 = any direction
+	virtual f32 normalBounds(vec3<f32>& /*axis*/) const { return 0.5f * F32_PI; }
 };
 
 struct PrimitiveAabox : public Primitive
 {
 	void updateAabb() override;
 	bool rayIntersect(const ray& ray, HitInfo& hitInfo) override;
+	f32 area() const override;
+	void samplePoint(f32 u1, f32 u2, vec3<f32>& p, vec3<f32>& n) const override;
 };
 
 struct PrimitiveSphere : public Primitive
@@ -49,12 +69,27 @@ struct PrimitiveSphere : public Primitive
 
 	void updateAabb() override;
 	bool rayIntersect(const ray& ray, HitInfo& hitInfo) override;
+	f32 area() const override;
+	void samplePoint(f32 u1, f32 u2, vec3<f32>& p, vec3<f32>& n) const override;
 };
 
 struct PrimitiveTriangle : public Primitive
 {
 	vec3<f32> vertex[3];
 
+	void updateAabb() override;
+	bool rayIntersect(const ray& ray, HitInfo& hitInfo) override;
+	f32 area() const override;
+	void samplePoint(f32 u1, f32 u2, vec3<f32>& p, vec3<f32>& n) const override;
+	f32 normalBounds(vec3<f32>& axis) const override;
+};
+
+struct PrimitiveVoxelTree : public Primitive
+{
+	VoxelTree tree;
+	//minimum mip level, ray cones add to it
+	u32 lod = 0;
+
 	void updateAabb() override;
 	bool rayIntersect(const ray& ray, HitInfo& hitInfo) override;
 };
@@ -0,0 +1,58 @@
+#include "ProgressReporter.h"
+
+ProgressReporter::ProgressReporter(u64 total, u32 workerCount, const std::function<void(float)>& callback, u32 intervalMs)
+	: total(total), workerCount(max(workerCount, 1u)), callback(callback), interval(intervalMs)
+{
+	counters.reset(new Counter[this->workerCount]);
+	if (this->callback)
+		thread = std::thread(&ProgressReporter::run, this);
+}
+
+ProgressReporter::~ProgressReporter()
+{
+	finish();
+}
+
+void ProgressReporter::finish()
+{
+	if (!thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+u64 ProgressReporter::done() const
+{
+	u64 sum = 0;
+	for (u32 i = 0; i < workerCount; i++)
+		sum += counters[i].value.load(std::memory_order_relaxed);
+	return sum;
+}
+
+void ProgressReporter::run()
+{
+	f32 reported = -1.0f;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		bool last = wake.wait_for(lock, interval, [this]() { return stop; });
+
+		//workers have joined before stop is set, the last sum is complete
+		f32 progress = last || total == 0 ? 100.0f : min(100.0f * f32(f64(done()) / f64(total)), 100.0f);
+		if (progress > reported)
+		{
+			reported = progress;
+			lock.unlock();
+			callback(progress);
+			lock.lock();
+		}
+
+		if (last)
+			return;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "../KDMath.h"
+
+/**
+* Work counters, one per worker thread on its own cache line, only ever written by that worker.
+* A single reporter thread sums them at a fixed interval and is the only caller of the callback:
+* calls never overlap, progress is in percent and never decreases, the last call reports 100.
+* Without a callback no thread is started and add() is a plain relaxed store.
+*/
+struct ProgressReporter
+{
+	ProgressReporter(u64 total, u32 workerCount, const std::function<void(float)>& callback, u32 intervalMs = 100);
+	~ProgressReporter();
+
+	ProgressReporter(const ProgressReporter&) = delete;
+	ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+	void add(u32 worker, u64 count)
+	{
+		//single writer per counter, no read-modify-write needed
+		std::atomic<u64>& value = counters[worker].value;
+		value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+	}
+
+	//stop the reporter after a final report, called by the destructor too
+	void finish();
+
+private:
+	struct alignas(64) Counter
+	{
+		std::atomic<u64> value{ 0 };
+	};
+
+	u64 done() const;
+	void run();
+
+	u64 total;
+	u32 workerCount;
+	std::function<void(float)> callback;
+	std::chrono::milliseconds interval;
+	std::unique_ptr<Counter[]> counters;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stop = false;
+};
@@ -11,7 +11,8 @@ bool ray_aabb_intersect(const vec3<f32>& pmin, const vec3<f32>& pmax, const ray&
 	float tNear = max(max(t1.x, t1.y), t1.z);
 	float tFar = min(min(t2.x, t2.y), t2.z);
 
-	return tFar >= tNear;
+	//also cull boxes past tMax, shadow rays stop at the light
+	return tFar >= tNear && tFar >= 0 && tNear <= ray.tMax;
 }
 
 void ray_aabb_intersect(const vec3<f32>& pmin, const vec3<f32>& pmax, const ray& ray, f32& t)
@@ -25,7 +26,7 @@ void ray_aabb_intersect(const vec3<f32>& pmin, const vec3<f32>& pmax, const ray&
 	float tNear = max(max(t1.x, t1.y), t1.z);
 	float tFar = min(min(t2.x, t2.y), t2.z);
 
-	if (tFar >= tNear)
+	if (tFar >= tNear && tFar >= 0)
 		t = tNear > 0 ? tNear : tFar;
 	else
 		t = F32_INF;
@@ -42,7 +43,7 @@ void ray_aabb_intersect(const vec3<f32>& pmin, const vec3<f32>& pmax, const ray&
 	float tNear = max(max(t1.x, t1.y), t1.z);
 	float tFar = min(min(t2.x, t2.y), t2.z);
 
-	if (tFar >= tNear)
+	if (tFar >= tNear && tFar >= 0)
 	{
 		t = tNear > 0 ? tNear : tFar;
 		normal = equal(t1, vec3<f32>(tNear)) * sign(ray.direction * -1);
@@ -59,13 +60,17 @@ void ray_sphere_intersect(const vec3<f32>& center, f32 radius, const ray& ray, f
 	f32 c = dot(oc, oc) - radius * radius;
 	f32 discriminant = b * b - 4 * a * c;
 
+	t = F32_INF;
 	if (discriminant >= 0)
 	{
-		t = (-b - sqrt(discriminant)) / (2.0f * a);
-		vec3<f32> hit_pos = ray.origin + ray.direction * t;
+		//nearest root in front of the origin, far root when starting inside
+		f32 t0 = (-b - sqrt(discriminant)) / (2.0f * a);
+		f32 t1 = (-b + sqrt(discriminant)) / (2.0f * a);
+		if (t0 > 0)
+			t = t0;
+		else if (t1 > 0)
+			t = t1;
 	}
-	else
-		t = F32_INF;
 }
 
 void ray_sphere_intersect(const vec3<f32>& center, f32 radius, const ray& ray, f32& t, vec3<f32>& normal)
@@ -76,14 +81,20 @@ void ray_sphere_intersect(const vec3<f32>& center, f32 radius, const ray& ray, f
 	f32 c = dot(oc, oc) - radius * radius;
 	f32 discriminant = b * b - 4 * a * c;
 
+	t = F32_INF;
 	if (discriminant >= 0)
 	{
-		t = (-b - sqrt(discriminant)) / (2.0f * a);
+		f32 t0 = (-b - sqrt(discriminant)) / (2.0f * a);
+		f32 t1 = (-b + sqrt(discriminant)) / (2.0f * a);
+		if (t0 > 0)
+			t = t0;
+		else if (t1 > 0)
+			t = t1;
+		else
+			return;
 		vec3<f32> hit_pos = ray.origin + ray.direction * t;
 		normal = normalize(hit_pos - center);
 	}
-	else
-		t = F32_INF;
 }
 
 void ray_triangle_intersect(const vec3<f32>& v0, const vec3<f32>& v1, const vec3<f32>& v2, 
@@ -2,11 +2,14 @@
 #include "../Util.h"
 #include "RayIntersection.h"
 #include "Sampling.h"
+#include "TileScheduler.h"
+#include "ProgressReporter.h"
+#include "Wavefront.h"
 
+#include <atomic>
+#include <cstring>
 #include <vector>
 #include <algorithm>
-#include <execution>
-#include <atomic>
 
 namespace RayTracer
 {
@@ -14,19 +17,338 @@ namespace RayTracer
 
 	BVHAccel bvhScene;
 
+	EnvironmentMap environmentMap;
+
 	RenderOutput renderOutput = RenderOutput::Beaut;
 
+	Integrator integrator = Integrator::Megakernel;
+
+	u32 aovMask = aov_bit(Aov::Beauty);
+
+	PostProcessSettings postProcess;
+
+	bool denoiseOutput = false;
+
+	DenoiseSettings denoiseSettings;
+
 	int maxDepth = 4;
 
+	bool nextEventEstimation = true;
+
+	int russianRouletteDepth = 3;
+
 	int samplesPerPixel = 64;
 
-	static f32 RENDER_PROGRESS = 0.0f;
+	bool progressive = false;
+
+	int samplesPerFrame = 1;
+
+	f32 voxelLodBounceSpread = 0.05f;
+
+	SamplerType samplerType = SamplerType::Sobol;
+
+	u32 threadCount = 0;
+
+	std::string checkpointFile;
+
+	f32 checkpointSeconds = 300.0f;
+
+	static const i32 TILE_SIZE = 16;
+
+	//paths per wavefront batch, bounds the path state of a worker to a few MB
+	static const u32 WAVEFRONT_PATHS = 1 << 14;
+
 	std::function<void(float)> renderProgressCallback;
+
+	bool adaptiveSampling = false;
+
+	f32 adaptiveThreshold = 0.02f;
+
+	int adaptiveMinSamples = 8;
+
+	int adaptiveMaxSamples = 256;
+
+	RenderStats renderStats;
+
+	//extension and shadow rays cast by the calling thread, read around each tile
+	static thread_local u64 RAYS_TRACED = 0;
+
+	//running luminance mean and variance, Welford
+	struct PixelState
+	{
+		u32 count = 0;
+		f32 mean = 0.0f;
+		f32 m2 = 0.0f;
+	};
+
+	//primary hit sums behind the feature AOVs
+	struct FeatureSum
+	{
+		vec3<f32> albedo;
+		vec3<f32> normal;
+		vec3<f32> bary;
+		f32 depth = 0.0f;
+		u32 hits = 0;
+		i32 primitiveId = -1;
+		//traversal work of all samples, RAYTRACE_STATS only
+		f32 cost = 0.0f;
+	};
+
+	//progressive HDR sums, one entry per pixel
+	struct Accumulation
+	{
+		std::vector<vec3<f32>> buffer;
+		std::vector<PixelState> pixels;
+		std::vector<FeatureSum> features;
+		i32 width = 0;
+		i32 height = 0;
+		u32 frameCount = 0;
+		u32 sampleCount = 0;
+		bool done = false;
+		u32 sceneVersion = 0;
+		u32 aovMask = 0;
+		Param param;
+	};
+	static Accumulation ACCUMULATION;
+
+	//last checkpoint of the accumulation, unset until the first progressive pass
+	static std::chrono::steady_clock::time_point CHECKPOINT_TIME;
+
+	const u32 CHECKPOINT_MAGIC = 0x5043524bu;
+	const u32 CHECKPOINT_VERSION = 5;
+
+	//everything a checkpoint stores besides the per pixel arrays, in host byte order.
+	//Written raw and zeroed first, headerSize catches a build that lays it out differently
+	struct CheckpointHeader
+	{
+		u32 magic;
+		u32 version;
+		u32 headerSize;
+		i32 width;
+		i32 height;
+		u32 frameCount;
+		u32 sampleCount;
+		u32 done;
+		u32 aovMask;
+		u64 primitiveCount;
+		i32 environmentWidth;
+		i32 environmentHeight;
+		u64 environmentHash;
+		Param param;
+		//settings the samples depend on, samplesPerFrame only moves pass boundaries
+		i32 maxDepth;
+		u32 nextEventEstimation;
+		i32 russianRouletteDepth;
+		i32 samplesPerPixel;
+		u32 adaptiveSampling;
+		f32 adaptiveThreshold;
+		i32 adaptiveMinSamples;
+		i32 adaptiveMaxSamples;
+		f32 voxelLodBounceSpread;
+		u32 samplerType;
+	};
+
+	static AovBuffers DISPLAY_AOVS;
+
+	static Denoiser DENOISER;
+
+	static std::vector<f32> DENOISED_BEAUTY;
+
+	//one per tile worker, reused across frames
+	static std::vector<Wavefront> WAVEFRONTS;
+
+	static const u32 FEATURE_AOVS = aov_bit(Aov::Albedo) | aov_bit(Aov::Normal) | aov_bit(Aov::Depth)
+		| aov_bit(Aov::PrimitiveId) | aov_bit(Aov::Barycentric);
 }
 
 using namespace RayTracer;
 
-void render(i32 width, i32 height, u32* buffer, bool parallel)
+static bool same_view(const Param& a, const Param& b)
+{
+	auto same = [](const vec3<f32>& u, const vec3<f32>& v) { return u.x == v.x && u.y == v.y && u.z == v.z; };
+	return a.cameraNdcXscale == b.cameraNdcXscale && a.cameraNdcYscale == b.cameraNdcYscale
+		&& same(a.cameraPosition, b.cameraPosition) && same(a.cameraRight, b.cameraRight)
+		&& same(a.cameraUp, b.cameraUp) && same(a.cameraFront, b.cameraFront);
+}
+
+static inline void welford_update(PixelState& state, const vec3<f32>& sample)
+{
+	f32 value = luminance(sample);
+	state.count++;
+	f32 delta = value - state.mean;
+	state.mean += delta / state.count;
+	state.m2 += delta * (value - state.mean);
+}
+
+static inline void feature_update(FeatureSum& feature, const PrimaryHit& primary, u32 sampleIndex)
+{
+	if (!primary.hit)
+		return;
+	feature.albedo += primary.albedo;
+	feature.normal += primary.normal;
+	feature.bary += primary.bary;
+	feature.depth += primary.depth;
+	feature.hits++;
+	if (sampleIndex == 1)
+		feature.primitiveId = primary.primitiveId;
+}
+
+//variance of the mean estimate, not of single samples
+static inline f32 mean_variance(const PixelState& state)
+{
+	return state.count > 1 ? state.m2 / (f32(state.count - 1) * state.count) : 0.0f;
+}
+
+//misses count as zero albedo and normal, depth averages over hits only
+static void write_aovs(AovBuffers& aovs, size_t pixel, const vec3<f32>& beauty, const FeatureSum& feature, u32 count, f32 variance)
+{
+	f32 inv = count > 0 ? 1.0f / count : 0.0f;
+	aovs.set(Aov::Beauty, pixel, beauty);
+	aovs.set(Aov::Albedo, pixel, feature.albedo * inv);
+	aovs.set(Aov::Normal, pixel, feature.normal * inv);
+	aovs.set(Aov::Barycentric, pixel, feature.bary * inv);
+	aovs.set(Aov::Depth, pixel, feature.hits > 0 ? feature.depth / feature.hits : 0.0f);
+	aovs.set(Aov::PrimitiveId, pixel, f32(feature.primitiveId));
+	aovs.set(Aov::SampleCount, pixel, f32(count));
+	aovs.set(Aov::Variance, pixel, variance);
+	aovs.set(Aov::Cost, pixel, count > 0 ? feature.cost * inv : 0.0f);
+}
+
+//traversal work of the calling thread since before
+static inline void add_cost(FeatureSum& feature, const TraversalStats& before)
+{
+	if constexpr (TRAVERSAL_STATS)
+		feature.cost += f32((traversal_stats() - before).work());
+}
+
+//relative standard error of the pixel mean under the threshold
+static inline bool pixel_converged(const PixelState& state)
+{
+	//the variance needs two samples
+	if (state.count < 2 || state.count < (u32)max(adaptiveMinSamples, 0))
+		return false;
+	f32 variance = state.m2 / (state.count - 1);
+	f32 error = sqrtf(variance / state.count);
+	return error <= adaptiveThreshold * max(state.mean, 1e-3f);
+}
+
+void reset_accumulation()
+{
+	ACCUMULATION.frameCount = 0;
+	ACCUMULATION.sampleCount = 0;
+	ACCUMULATION.done = false;
+	std::fill(ACCUMULATION.buffer.begin(), ACCUMULATION.buffer.end(), vec3<f32>(0.0f));
+	std::fill(ACCUMULATION.pixels.begin(), ACCUMULATION.pixels.end(), PixelState());
+	std::fill(ACCUMULATION.features.begin(), ACCUMULATION.features.end(), FeatureSum());
+}
+
+static CheckpointHeader checkpoint_header()
+{
+	const Accumulation& accum = ACCUMULATION;
+	//padding bytes too, a checkpoint is a pure function of the render
+	CheckpointHeader header;
+	memset(static_cast<void*>(&header), 0, sizeof(header));
+	header.magic = CHECKPOINT_MAGIC;
+	header.version = CHECKPOINT_VERSION;
+	header.headerSize = sizeof(CheckpointHeader);
+	header.width = accum.width;
+	header.height = accum.height;
+	header.frameCount = accum.frameCount;
+	header.sampleCount = accum.sampleCount;
+	header.done = accum.done;
+	header.aovMask = accum.aovMask;
+	header.primitiveCount = bvhScene.primitives.size();
+	header.environmentWidth = environmentMap.width;
+	header.environmentHeight = environmentMap.height;
+	header.environmentHash = environmentMap.hash;
+	header.param = accum.param;
+	header.maxDepth = maxDepth;
+	header.nextEventEstimation = nextEventEstimation;
+	header.russianRouletteDepth = russianRouletteDepth;
+	header.samplesPerPixel = samplesPerPixel;
+	header.adaptiveSampling = adaptiveSampling;
+	header.adaptiveThreshold = adaptiveThreshold;
+	header.adaptiveMinSamples = adaptiveMinSamples;
+	header.adaptiveMaxSamples = adaptiveMaxSamples;
+	header.voxelLodBounceSpread = voxelLodBounceSpread;
+	header.samplerType = u32(samplerType);
+	return header;
+}
+
+bool save_checkpoint(const char* filename)
+{
+	const Accumulation& accum = ACCUMULATION;
+	CheckpointHeader header = checkpoint_header();
+	return write_file_atomic(filename, {
+		{ &header, sizeof(header) },
+		{ accum.buffer.data(), accum.buffer.size() * sizeof(vec3<f32>) },
+		{ accum.pixels.data(), accum.pixels.size() * sizeof(PixelState) },
+		{ accum.features.data(), accum.features.size() * sizeof(FeatureSum) } });
+}
+
+bool load_checkpoint(const char* filename)
+{
+	MappedFile file;
+	if (!file.open(filename) || file.size < sizeof(CheckpointHeader))
+		return false;
+
+	CheckpointHeader header;
+	memcpy(&header, file.data, sizeof(header));
+	CheckpointHeader expected = checkpoint_header();
+	size_t pixelCount = size_t(max(header.width, 0)) * max(header.height, 0);
+	size_t size = sizeof(header) + pixelCount * (sizeof(vec3<f32>) + sizeof(PixelState) + sizeof(FeatureSum));
+	if (header.magic != expected.magic || header.version != expected.version || header.headerSize != expected.headerSize
+		|| file.size != size)
+	{
+		printf("[Checkpoint] %s is not a checkpoint of this build\n", filename);
+		return false;
+	}
+	if (header.primitiveCount != expected.primitiveCount || header.environmentWidth != expected.environmentWidth
+		|| header.environmentHeight != expected.environmentHeight || header.environmentHash != expected.environmentHash
+		|| header.maxDepth != expected.maxDepth
+		|| header.nextEventEstimation != expected.nextEventEstimation || header.russianRouletteDepth != expected.russianRouletteDepth
+		|| header.samplesPerPixel != expected.samplesPerPixel || header.adaptiveSampling != expected.adaptiveSampling
+		|| header.adaptiveThreshold != expected.adaptiveThreshold || header.adaptiveMinSamples != expected.adaptiveMinSamples
+		|| header.adaptiveMaxSamples != expected.adaptiveMaxSamples || header.voxelLodBounceSpread != expected.voxelLodBounceSpread
+		|| header.samplerType != expected.samplerType)
+	{
+		printf("[Checkpoint] %s was rendered with another scene or settings\n", filename);
+		return false;
+	}
+
+	Accumulation& accum = ACCUMULATION;
+	const u8* data = file.data + sizeof(header);
+	accum.buffer.resize(pixelCount);
+	accum.pixels.resize(pixelCount);
+	accum.features.resize(pixelCount);
+	memcpy(accum.buffer.data(), data, pixelCount * sizeof(vec3<f32>));
+	data += pixelCount * sizeof(vec3<f32>);
+	memcpy(accum.pixels.data(), data, pixelCount * sizeof(PixelState));
+	data += pixelCount * sizeof(PixelState);
+	memcpy(accum.features.data(), data, pixelCount * sizeof(FeatureSum));
+
+	accum.width = header.width;
+	accum.height = header.height;
+	accum.frameCount = header.frameCount;
+	accum.sampleCount = header.sampleCount;
+	accum.done = header.done != 0;
+	accum.aovMask = header.aovMask;
+	accum.param = header.param;
+	accum.sceneVersion = bvhScene.version;
+	return true;
+}
+
+int accumulated_samples()
+{
+	return ACCUMULATION.sampleCount;
+}
+
+bool accumulation_done()
+{
+	return ACCUMULATION.done;
+}
+
+Param camera_param()
 {
 	Param param;
 	param.cameraPosition = camera.getPositon();
@@ -35,162 +357,587 @@ void render(i32 width, i32 height, u32* buffer, bool parallel)
 	camera.getBasisVectors(param.cameraRight, param.cameraUp, param.cameraFront);
 	//if right-handed local front vector = -1
 	//param.cameraFront = transform_direction(camera.getWorldMatrix(), vec3<f32>(0, 0, -1));
+	return param;
+}
 
-	RENDER_PROGRESS = 0.0f;
-	std::atomic<int> render_count(0);
-	auto renderPixel = [&](i32 i, i32 j)
+//renders the pixels of region into aovs, which covers region only. Progressive accumulation is full frame
+static void render_frame(i32 width, i32 height, const Tile& region, Param param, AovBuffers& aovs, bool parallel)
+{
+	i32 regionWidth = region.x1 - region.x0;
+	i32 regionHeight = region.y1 - region.y0;
+	auto aovIndex = [&](i32 i, i32 j) { return size_t(j - region.y0) * regionWidth + (i - region.x0); };
+
+	Accumulation& accum = ACCUMULATION;
+	if (progressive)
 	{
-		if (renderOutput == RenderOutput::Beaut)
+		if (accum.width != width || accum.height != height)
+		{
+			accum.width = width;
+			accum.height = height;
+			accum.buffer.assign(width * height, vec3<f32>(0.0f));
+			accum.pixels.assign(width * height, PixelState());
+			accum.features.assign(width * height, FeatureSum());
+			reset_accumulation();
+		}
+		else if (!same_view(accum.param, param) || accum.sceneVersion != bvhScene.version || accum.aovMask != aovs.mask)
 		{
-			vec3<f32> hdr_color = ray_gen(i, j, width, height, param);
-			buffer[j * width + i] = rgb2hex(hdr_color);
+			reset_accumulation();
+		}
+		accum.param = param;
+		accum.sceneVersion = bvhScene.version;
+		accum.aovMask = aovs.mask;
+		param.frameCount = accum.frameCount;
+	}
+
+	//per pixel sample cap, adaptive sampling hands the budget of converged pixels to noisy ones
+	//at least one sample and never below the adaptive minimum
+	u32 maxSamples = (u32)max(adaptiveSampling ? max(adaptiveMaxSamples, max(adaptiveMinSamples, 1)) : samplesPerPixel, 0);
+
+	//feature planes come from the primary hits of the beauty samples
+	bool features = (aovs.mask & FEATURE_AOVS) != 0;
+	//fixed sampling keeps no pixel statistics unless asked for them
+	bool variance = aovs.has(Aov::Variance);
+
+	//returns samples taken
+	auto renderPixel = [&](i32 i, i32 j) -> u32
+	{
+		size_t index = size_t(j) * width + i;
+		PrimaryHit hit;
+		PrimaryHit* primary = features ? &hit : nullptr;
+		TraversalStats before = traversal_stats();
+
+		if (progressive)
+		{
+			vec3<f32>& sum = accum.buffer[index];
+			PixelState& state = accum.pixels[index];
+			FeatureSum& feature = accum.features[index];
+			u32 taken = 0;
+			for (int s = 0; s < samplesPerFrame; s++)
+			{
+				if (state.count >= maxSamples || (adaptiveSampling && pixel_converged(state)))
+					break;
+				u32 sampleIndex = state.count + 1;
+				vec3<f32> sample = ray_gen_sample(i, j, width, height, param, sampleIndex, primary);
+				sum += sample;
+				welford_update(state, sample);
+				if (primary)
+					feature_update(feature, hit, sampleIndex);
+				taken++;
+			}
+			add_cost(feature, before);
+			write_aovs(aovs, aovIndex(i, j), state.count > 0 ? sum / (f32)state.count : sum, feature, state.count, mean_variance(state));
+			return taken;
+		}
+		else if (adaptiveSampling)
+		{
+			vec3<f32> sum;
+			PixelState state;
+			FeatureSum feature;
+			while (state.count < maxSamples && !pixel_converged(state))
+			{
+				u32 sampleIndex = state.count + 1;
+				vec3<f32> sample = ray_gen_sample(i, j, width, height, param, sampleIndex, primary);
+				sum += sample;
+				welford_update(state, sample);
+				if (primary)
+					feature_update(feature, hit, sampleIndex);
+			}
+			add_cost(feature, before);
+			write_aovs(aovs, aovIndex(i, j), state.count > 0 ? sum / (f32)state.count : sum, feature, state.count, mean_variance(state));
+			return state.count;
 		}
 		else
 		{
-			buffer[j * width + i] = rgb2hex(ray_gen_single(i, j, width, height, param));
+			//fixed sampling counts sample indices down from samplesPerPixel
+			vec3<f32> sum;
+			PixelState state;
+			FeatureSum feature;
+			for (int sppCount = samplesPerPixel; sppCount > 0; sppCount--)
+			{
+				vec3<f32> sample = ray_gen_sample(i, j, width, height, param, sppCount, primary);
+				sum += sample;
+				if (variance)
+					welford_update(state, sample);
+				if (primary)
+					feature_update(feature, hit, sppCount);
+			}
+			add_cost(feature, before);
+			write_aovs(aovs, aovIndex(i, j), sum / (f32)samplesPerPixel, feature, samplesPerPixel, mean_variance(state));
+			return samplesPerPixel;
 		}
+	};
 
-		//buffer[j * width + i] = rgb2hex(255 * u, 255 * v, 0);
+	//same sampling as renderPixel for a whole tile, every pixel adds its samples to one batch.
+	//A batch holds one sample per pixel when adaptive sampling has to test convergence after each
+	auto renderTileWavefront = [&](const Tile& tile, Wavefront& wave) -> u64
+	{
+		i32 tileWidth = tile.x1 - tile.x0;
+		u32 pixelCount = u32(tileWidth * (tile.y1 - tile.y0));
+		auto pixelIndex = [&](u32 k) { return size_t(tile.y0 + i32(k) / tileWidth) * width + tile.x0 + i32(k) % tileWidth; };
+
+		//progressive sums live in the accumulation, the others only for this call
+		std::vector<vec3<f32>> sums(progressive ? 0 : pixelCount);
+		std::vector<PixelState> states(progressive ? 0 : pixelCount);
+		std::vector<FeatureSum> featureSums(progressive ? 0 : pixelCount);
+		std::vector<u32> taken(pixelCount, 0);
+		auto sumOf = [&](u32 k) -> vec3<f32>& { return progressive ? accum.buffer[pixelIndex(k)] : sums[k]; };
+		auto stateOf = [&](u32 k) -> PixelState& { return progressive ? accum.pixels[pixelIndex(k)] : states[k]; };
+		auto featureOf = [&](u32 k) -> FeatureSum& { return progressive ? accum.features[pixelIndex(k)] : featureSums[k]; };
+
+		//samples pixel k takes in the next batch
+		auto due = [&](u32 k) -> u32
+		{
+			const PixelState& state = stateOf(k);
+			if (state.count >= maxSamples || (adaptiveSampling && pixel_converged(state)))
+				return 0;
+			if (progressive)
+			{
+				if (taken[k] >= (u32)samplesPerFrame)
+					return 0;
+				return adaptiveSampling ? 1 : min((u32)samplesPerFrame - taken[k], maxSamples - state.count);
+			}
+			return adaptiveSampling ? 1 : (u32)samplesPerPixel - taken[k];
+		};
 
-		render_count++;
-		f32 progress = render_count / float(width * height);
-		if (progress - RENDER_PROGRESS > 0.001f || progress == 1.0f)
+		u32 perPixel = max(1u, WAVEFRONT_PATHS / pixelCount);
+		std::vector<u32> batchPixels;
+		u64 tileSamples = 0;
+		while (true)
 		{
-			RENDER_PROGRESS = progress;
-			if (renderProgressCallback)
+			wave.clear();
+			batchPixels.clear();
+			for (u32 k = 0; k < pixelCount; k++)
+			{
+				u32 n = min(due(k), perPixel);
+				for (u32 s = 0; s < n; s++)
+				{
+					//fixed sampling counts down like the megakernel
+					u32 sampleIndex = (progressive || adaptiveSampling) ? stateOf(k).count + 1 + s : samplesPerPixel - taken[k] - s;
+					wave.add(tile.x0 + i32(k) % tileWidth, tile.y0 + i32(k) / tileWidth, sampleIndex);
+					batchPixels.push_back(k);
+				}
+			}
+			if (wave.size() == 0)
+				break;
+
+			wave.trace(width, height, param, features);
+			for (u32 path = 0; path < wave.size(); path++)
 			{
-				renderProgressCallback(RENDER_PROGRESS * 100.f);
+				u32 k = batchPixels[path];
+				u32 sampleIndex = (progressive || adaptiveSampling) ? stateOf(k).count + 1 : samplesPerPixel - taken[k];
+				const vec3<f32>& sample = wave.result[path];
+				sumOf(k) += sample;
+				if (progressive || adaptiveSampling || variance)
+					welford_update(stateOf(k), sample);
+				if (features)
+					feature_update(featureOf(k), wave.primary[path], sampleIndex);
+				if constexpr (TRAVERSAL_STATS)
+					featureOf(k).cost += wave.cost[path];
+				taken[k]++;
 			}
+			tileSamples += wave.size();
+		}
+
+		for (u32 k = 0; k < pixelCount; k++)
+		{
+			u32 count = (progressive || adaptiveSampling) ? stateOf(k).count : taken[k];
+			const vec3<f32>& sum = sumOf(k);
+			vec3<f32> beauty = count > 0 ? sum / (f32)count : sum;
+			write_aovs(aovs, aovIndex(tile.x0 + i32(k) % tileWidth, tile.y0 + i32(k) / tileWidth), beauty, featureOf(k), count, mean_variance(stateOf(k)));
 		}
+		return tileSamples;
 	};
 
-	if (parallel)
+	//counted per tile or row, callback runs on the reporter thread only
+	u32 workerCount = parallel ? tile_worker_count(threadCount) : 1;
+	ProgressReporter progress(u64(regionWidth) * regionHeight, workerCount, renderProgressCallback);
+
+	//scheduled over the region, tile corners stay on the TILE_SIZE grid of the region origin
+	auto scheduleRegion = [&](const std::function<void(const Tile& tile, u32 worker)>& func)
 	{
-		Profiler profiler("render parallel");
+		schedule_tiles(regionWidth, regionHeight, TILE_SIZE, [&](const Tile& tile, u32 worker)
+			{
+				func(Tile{ tile.x0 + region.x0, tile.y0 + region.y0, tile.x1 + region.x0, tile.y1 + region.y0 }, worker);
+			}, workerCount);
+	};
 
-		std::vector<i32> pixelIndices;
-		pixelIndices.resize(width * height);
-		for (int i = 0; i < width * height; i++)
-			pixelIndices[i] = i;
-		std::for_each(std::execution::par_unseq, pixelIndices.begin(), pixelIndices.end(),
-			[&](auto&& index)
+	std::atomic<u64> samples(0);
+	std::atomic<u64> rays(0);
+	//one slot per worker, summed after the frame
+	std::vector<TraversalStats> traversal(workerCount);
+	if (integrator == Integrator::Wavefront)
+	{
+		if (WAVEFRONTS.size() < workerCount)
+			WAVEFRONTS.resize(workerCount);
+		auto renderTile = [&](const Tile& tile, u32 worker)
+		{
+			u64 raysBefore = RAYS_TRACED;
+			TraversalStats before = traversal_stats();
+			samples += renderTileWavefront(tile, WAVEFRONTS[worker]);
+			rays += RAYS_TRACED - raysBefore;
+			traversal[worker] += traversal_stats() - before;
+			progress.add(worker, u64(tile.x1 - tile.x0) * (tile.y1 - tile.y0));
+		};
+		if (parallel)
+		{
+			scheduleRegion(renderTile);
+		}
+		else
+		{
+			for (i32 y = region.y0; y < region.y1; y += TILE_SIZE)
+				for (i32 x = region.x0; x < region.x1; x += TILE_SIZE)
+					renderTile(Tile{ x, y, min(x + TILE_SIZE, region.x1), min(y + TILE_SIZE, region.y1) }, 0);
+		}
+	}
+	else if (parallel)
+	{
+		scheduleRegion([&](const Tile& tile, u32 worker)
 			{
-				renderPixel(index % width, index / width);
+				u64 tileSamples = 0;
+				u64 raysBefore = RAYS_TRACED;
+				TraversalStats before = traversal_stats();
+				for (i32 j = tile.y0; j < tile.y1; j++)
+				{
+					for (i32 i = tile.x0; i < tile.x1; i++)
+					{
+						tileSamples += renderPixel(i, j);
+					}
+				}
+				samples += tileSamples;
+				rays += RAYS_TRACED - raysBefore;
+				traversal[worker] += traversal_stats() - before;
+				progress.add(worker, u64(tile.x1 - tile.x0) * (tile.y1 - tile.y0));
 			});
 	}
 	else
 	{
-		Profiler profiler("render");
-		for (i32 j = height - 1; j >= 0; j--)
+		u64 raysBefore = RAYS_TRACED;
+		TraversalStats before = traversal_stats();
+		for (i32 j = region.y1 - 1; j >= region.y0; j--)
 		{
-			for (i32 i = 0; i < width; i++)
+			for (i32 i = region.x0; i < region.x1; i++)
 			{
-				renderPixel(i, j);
+				samples += renderPixel(i, j);
+			}
+			progress.add(0, regionWidth);
+		}
+		rays += RAYS_TRACED - raysBefore;
+		traversal[0] += traversal_stats() - before;
+	}
+	progress.finish();
+
+	//saved against a fixed samplesPerPixel (or samplesPerFrame) per pixel
+	u64 pixelCount = u64(regionWidth) * regionHeight;
+	u64 fixedSamples = pixelCount * (progressive ? min(samplesPerFrame, samplesPerPixel) : samplesPerPixel);
+	renderStats.samples = samples;
+	renderStats.samplesSaved = i64(fixedSamples) - i64(samples);
+	renderStats.rays = rays;
+	renderStats.traversal = TraversalStats();
+	for (const TraversalStats& stats : traversal)
+		renderStats.traversal += stats;
+
+	if (progressive)
+	{
+		if (samples > 0)
+		{
+			accum.frameCount++;
+			accum.sampleCount = min(accum.sampleCount + samplesPerFrame, maxSamples);
+		}
+		bool wasDone = accum.done;
+		accum.done = samples == 0 || (!adaptiveSampling && accum.sampleCount >= maxSamples);
+
+		using clock = std::chrono::steady_clock;
+		bool frame = regionWidth == width && regionHeight == height;
+		if (!checkpointFile.empty() && frame)
+		{
+			clock::time_point now = clock::now();
+			if (CHECKPOINT_TIME == clock::time_point())
+				CHECKPOINT_TIME = now;
+			if ((accum.done && !wasDone) || now - CHECKPOINT_TIME >= std::chrono::duration<f32>(checkpointSeconds))
+			{
+				if (!save_checkpoint(checkpointFile.c_str()))
+					printf("[Checkpoint] failed to write %s\n", checkpointFile.c_str());
+				CHECKPOINT_TIME = now;
 			}
 		}
 	}
 }
 
-vec3<f32> ray_gen_single(i32 x, i32 y, i32 width, i32 height, const RayTracer::Param& param)
+static Aov output_aov(RenderOutput output)
 {
-	f32 u = (f32(x) + 0.5f) / (width - 1);
-	f32 v = (f32(y) + 0.5f) / (height - 1);
+	switch (output)
+	{
+	case RenderOutput::Albedo: return Aov::Albedo;
+	case RenderOutput::Normal: return Aov::Normal;
+	case RenderOutput::Depth: return Aov::Depth;
+	case RenderOutput::Barycentric: return Aov::Barycentric;
+	case RenderOutput::PrimitiveId: return Aov::PrimitiveId;
+	case RenderOutput::SampleCount: return Aov::SampleCount;
+	case RenderOutput::Cost: return Aov::Cost;
+	default: return Aov::Beauty;
+	}
+}
 
-	vec2<f32> uv(u, v);
-	//NDC [[0, 0], [1, 1]] -> [[-1, -1], [1, 1]]
-	uv.x = uv.x * 2.0f - 1.0f;
-	uv.y = uv.y * 2.0f - 1.0f;
-	//perspective fov relative
-	uv.x *= param.cameraNdcXscale;
-	uv.y *= param.cameraNdcYscale; // NDC top-left=negative
+u32 display_mask()
+{
+	return aovMask | aov_bit(output_aov(renderOutput)) | (denoiseOutput ? denoise_aovs() : 0);
+}
 
-	ray ray;
-	ray.origin = param.cameraPosition;
-	//view space vector to world space
-	ray.direction = param.cameraRight * uv.x + param.cameraUp * uv.y + param.cameraFront;
-	ray.direction = normalize(ray.direction);
+//black, blue, cyan, green, yellow, red over [0, 1]
+static vec3<f32> heat_color(f32 t)
+{
+	static const vec3<f32> STOPS[] = { {0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0} };
+	const int last = int(sizeof(STOPS) / sizeof(STOPS[0])) - 1;
+	f32 x = min(max(t, 0.0f), 1.0f) * last;
+	int k = min(int(x), last - 1);
+	return STOPS[k] + (STOPS[k + 1] - STOPS[k]) * (x - k);
+}
 
-	HitInfo hitInfo;
-	bvhScene.rayIntersect(ray, hitInfo);
+//beauty goes through the denoiser and post process, cost is shown as a heatmap,
+//other color planes are saturated and scalar planes normalized by their frame maximum
+void display_aov(const AovBuffers& aovs, u32* buffer, bool parallel)
+{
+	Aov aov = output_aov(renderOutput);
+	const f32* plane = aovs.plane(aov);
+	if (aov == Aov::Beauty)
+	{
+		if (denoiseOutput)
+		{
+			DENOISED_BEAUTY.resize(size_t(aovs.width) * aovs.height * 3);
+			DENOISER.apply(aovs, DENOISED_BEAUTY.data(), denoiseSettings, parallel);
+			plane = DENOISED_BEAUTY.data();
+		}
+		tonemap_rgb(plane, aovs.width, aovs.height, buffer, postProcess, parallel);
+		return;
+	}
 
-	if (hitInfo.t < F32_INF)
+	size_t pixelCount = size_t(aovs.width) * aovs.height;
+	auto saturate = [](const vec3<f32>& c) { return min(max(c, vec3<f32>(0.0f)), vec3<f32>(1.0f)); };
+
+	f32 maxValue = 0.0f;
+	if (AovBuffers::channels(aov) == 1)
+	{
+		for (size_t i = 0; i < pixelCount; i++)
+			maxValue = max(maxValue, plane[i]);
+	}
+	f32 scale = maxValue > 0.0f ? 1.0f / maxValue : 0.0f;
+
+	for (size_t i = 0; i < pixelCount; i++)
 	{
-		if (renderOutput == RenderOutput::Albedo)
+		vec3<f32> color;
+		if (aov == Aov::PrimitiveId)
 		{
-			return hitInfo.material.color;
+			//hashed id, background black
+			i32 id = i32(plane[i]);
+			u32 h = id < 0 ? 0 : rnd_init(u32(id), 0x51ed27u);
+			color = id < 0 ? vec3<f32>(0.0f) : vec3<f32>((h & 0xff) / 255.0f, ((h >> 8) & 0xff) / 255.0f, ((h >> 16) & 0xff) / 255.0f);
 		}
-		else if (renderOutput == RenderOutput::Normal)
+		else if (aov == Aov::Cost)
 		{
-			vec3<f32> N = hitInfo.normal;
-			return 0.5f * vec3<f32>(N.x + 1, N.y + 1, N.z + 1);
+			color = heat_color(plane[i] * scale);
 		}
-		else if (renderOutput == RenderOutput::Barycentric)
+		else if (AovBuffers::channels(aov) == 1)
 		{
-			return hitInfo.bary;
+			color = vec3<f32>(plane[i] * scale);
 		}
 		else
 		{
-			return vec3<f32>(1, 0, 1);
+			color = vec3<f32>(plane[i * 3], plane[i * 3 + 1], plane[i * 3 + 2]);
+			if (aov == Aov::Normal)
+				color = 0.5f * (color + vec3<f32>(1.0f));
 		}
+		buffer[i] = rgb2hex(saturate(color));
 	}
-	else
+}
+
+void render(i32 width, i32 height, u32* buffer, bool parallel)
+{
+	DISPLAY_AOVS.resize(width, height, display_mask());
+	{
+		Profiler profiler(parallel ? "render parallel" : "render");
+		render_frame(width, height, Tile{ 0, 0, width, height }, camera_param(), DISPLAY_AOVS, parallel);
+	}
+	display_aov(DISPLAY_AOVS, buffer, parallel);
+
+	if (adaptiveSampling)
 	{
-		return vec3<f32>(0.1f);
+		printf("[Render] adaptive sampling %llu samples, saved %lld\n", (unsigned long long)renderStats.samples, (long long)renderStats.samplesSaved);
 	}
 }
 
-vec3<f32> ray_gen(i32 x, i32 y, i32 width, i32 height, const Param& param)
+void render(i32 width, i32 height, AovBuffers& aovs, bool parallel)
 {
-	int sppCount = samplesPerPixel;
-	vec3<f32> result;
-	do
-	{
-		u32 rnd_seed = rnd_init(x + y * width, sppCount); //param.frameCount
-		
-		//亚像素内抖动抗锯齿
-		vec2<f32> subpixel_jitter(rnd(rnd_seed), rnd(rnd_seed));
-		f32 u = (f32(x) + subpixel_jitter.x) / (width - 1);
-		f32 v = (f32(y) + subpixel_jitter.y) / (height - 1);
-
-		vec2<f32> uv(u, v);
-		uv.x = uv.x * 2.0f - 1.0f;
-		uv.y = uv.y * 2.0f - 1.0f;
-		uv.x *= param.cameraNdcXscale;
-		uv.y *= param.cameraNdcYscale;
-
-		ray ray;
-		ray.origin = param.cameraPosition;
-		ray.direction = normalize(param.cameraRight * uv.x + param.cameraUp * uv.y + param.cameraFront);
-
-		Payload payload;
-		payload.seed = rnd_seed;
-		payload.radiance = vec3<f32>(0.0f);
-		payload.attenuation = vec3<f32>(1.0f);
-		payload.done = false;
+	aovs.resize(width, height, aovs.mask);
+	render_frame(width, height, Tile{ 0, 0, width, height }, camera_param(), aovs, parallel);
+}
+
+void render_region(i32 width, i32 height, const Tile& region, const Param& param, AovBuffers& aovs, bool parallel)
+{
+	aovs.resize(region.x1 - region.x0, region.y1 - region.y0, aovs.mask);
+	render_frame(width, height, region, param, aovs, parallel);
+}
+
+const AovBuffers& render_aovs()
+{
+	return DISPLAY_AOVS;
+}
 
-		for (int depth = 0; depth < maxDepth; depth++)
+const RenderStats& render_until(i32 width, i32 height, u32* buffer, std::chrono::steady_clock::time_point deadline, bool parallel)
+{
+	using clock = std::chrono::steady_clock;
+	clock::time_point start = clock::now();
+
+	bool wasProgressive = progressive;
+	progressive = true;
+	DISPLAY_AOVS.resize(width, height, display_mask());
+
+	u32 passes = 0;
+	u64 samples = 0;
+	u64 rays = 0;
+	TraversalStats traversal;
+	i64 samplesSaved = 0;
+	while (true)
+	{
+		clock::time_point passStart = clock::now();
+		render_frame(width, height, Tile{ 0, 0, width, height }, camera_param(), DISPLAY_AOVS, parallel);
+		clock::time_point passEnd = clock::now();
+
+		passes++;
+		samples += renderStats.samples;
+		rays += renderStats.rays;
+		traversal += renderStats.traversal;
+		samplesSaved += renderStats.samplesSaved;
+
+		if (accumulation_done())
+			break;
+		if (passEnd + (passEnd - passStart) > deadline)
+			break;
+	}
+	progressive = wasProgressive;
+	display_aov(DISPLAY_AOVS, buffer, parallel);
+
+	renderStats.samples = samples;
+	renderStats.rays = rays;
+	renderStats.traversal = traversal;
+	renderStats.samplesSaved = samplesSaved;
+	renderStats.passes = passes;
+	renderStats.seconds = std::chrono::duration<f64>(clock::now() - start).count();
+
+	const Accumulation& accum = ACCUMULATION;
+	renderStats.minSpp = renderStats.maxSpp = 0;
+	renderStats.meanSpp = 0.0f;
+	if (!accum.pixels.empty())
+	{
+		u32 minSpp = UINT32_MAX, maxSpp = 0;
+		u64 sum = 0;
+		for (auto& state : accum.pixels)
 		{
-			payload.radiance = vec3<f32>(0.0f);
+			minSpp = min(minSpp, state.count);
+			maxSpp = max(maxSpp, state.count);
+			sum += state.count;
+		}
+		renderStats.minSpp = minSpp;
+		renderStats.maxSpp = maxSpp;
+		renderStats.meanSpp = f32(f64(sum) / accum.pixels.size());
+	}
 
-			trace_ray(ray, bvhScene, payload);
+	printf("[Render] %u passes in %f seconds, spp min %u mean %.1f max %u\n", renderStats.passes, renderStats.seconds,
+		renderStats.minSpp, renderStats.meanSpp, renderStats.maxSpp);
+	return renderStats;
+}
 
-			result += payload.attenuation * payload.radiance;
+ray camera_ray(i32 x, i32 y, i32 width, i32 height, const Param& param, Sampler& sampler)
+{
+	//亚像素内抖动抗锯齿
+	vec2<f32> subpixel_jitter = sampler.get2D(SampleDimension::Camera);
+	f32 u = (f32(x) + subpixel_jitter.x) / (width - 1);
+	f32 v = (f32(y) + subpixel_jitter.y) / (height - 1);
 
-			if (payload.done)
-				break;
+	vec2<f32> uv(u, v);
+	uv.x = uv.x * 2.0f - 1.0f;
+	uv.y = uv.y * 2.0f - 1.0f;
+	uv.x *= param.cameraNdcXscale;
+	uv.y *= param.cameraNdcYscale;
+
+	ray ray;
+	ray.origin = param.cameraPosition;
+	ray.direction = normalize(param.cameraRight * uv.x + param.cameraUp * uv.y + param.cameraFront);
+	//pixel footprint
+	ray.coneSpread = 2.0f * param.cameraNdcYscale / height;
+	return ray;
+}
+
+void record_primary_hit(const ray& ray, const HitInfo& hitInfo, const Param& param, PrimaryHit& primary)
+{
+	primary.hit = true;
+	primary.albedo = hitInfo.material.color;
+	primary.normal = faceforward(ray.direction * -1, hitInfo.normal);
+	primary.bary = hitInfo.bary;
+	primary.depth = hitInfo.t * dot(ray.direction, param.cameraFront);
+	primary.primitiveId = hitInfo.primitive ? hitInfo.primitive->id : -1;
+}
 
-			//RUSSIAN_ROULETTE
+//survive with probability of the throughput, reweight to stay unbiased
+bool russian_roulette(vec3<f32>& attenuation, int depth, Sampler& sampler)
+{
+	if (russianRouletteDepth < 0 || depth < russianRouletteDepth)
+		return true;
+	f32 p = min(max(attenuation.x, max(attenuation.y, attenuation.z)), 0.95f);
+	if (sampler.get1D(SampleDimension::RussianRoulette) >= p)
+		return false;
+	attenuation /= p;
+	return true;
+}
+
+vec3<f32> ray_gen_sample(i32 x, i32 y, i32 width, i32 height, const Param& param, u32 sampleIndex, PrimaryHit* primary)
+{
+	vec3<f32> result;
+	Payload payload;
+	payload.sampler.start(samplerType, x, y, width, sampleIndex);
+	ray ray = camera_ray(x, y, width, height, param, payload.sampler);
+
+	payload.radiance = vec3<f32>(0.0f);
+	payload.attenuation = vec3<f32>(1.0f);
+	payload.done = false;
+
+	for (int depth = 0; depth < maxDepth; depth++)
+	{
+		payload.radiance = vec3<f32>(0.0f);
 
-			ray.origin = payload.origin;
-			ray.direction = payload.direction;
+		//radiance of this vertex is weighted by the throughput up to it, closest_hit already folds in its own albedo
+		vec3<f32> throughput = payload.attenuation;
+		payload.depth = depth;
+		trace_ray(ray, bvhScene, payload);
+
+		result += throughput * payload.radiance;
+
+		//features come for free from the camera ray hit
+		if (depth == 0 && primary)
+		{
+			primary->hit = false;
+			if (payload.hitInfo.t < F32_INF)
+				record_primary_hit(ray, payload.hitInfo, param, *primary);
 		}
-	} while (--sppCount > 0);
 
-	return result / (f32)samplesPerPixel;
+		if (payload.done)
+			break;
+
+		//RUSSIAN_ROULETTE
+		if (!russian_roulette(payload.attenuation, depth, payload.sampler))
+			break;
+
+		ray.origin = payload.origin;
+		ray.direction = payload.direction;
+		ray.coneWidth = payload.coneWidth;
+		ray.coneSpread = payload.coneSpread;
+	}
+
+	return result;
 }
 
 void trace_ray(ray& ray, const BVHAccel& scene, Payload& payload)
 {
+	RAYS_TRACED++;
 	HitInfo hitInfo;
 	if (scene.rayIntersect(ray, hitInfo))
 	{
@@ -199,36 +946,170 @@ void trace_ray(ray& ray, const BVHAccel& scene, Payload& payload)
 
 	if (hitInfo.t < F32_INF)
 	{
+		count_bounce();
 		closest_hit(ray, payload);
 		return;
 	}
 	miss_hit(ray, payload);
 }
 
+//solid angle pdf of reaching a point on light, emitters are two-sided
+static inline f32 light_pdf(const Primitive* light, f32 pmf, f32 dist2, f32 cosLight)
+{
+	f32 area = light->area();
+	if (pmf <= 0.0f || area <= 0.0f || cosLight <= 0.0f)
+		return 0.0f;
+	return pmf * dist2 / (area * cosLight);
+}
+
+//share of light samples aimed at the environment, the rest go to the emitters
+static inline f32 environment_probability()
+{
+	if (environmentMap.table.empty())
+		return 0.0f;
+	return bvhScene.lightList.empty() ? 1.0f : 0.5f;
+}
+
+bool sample_direct_light(const vec3<f32>& P, const vec3<f32>& N, Sampler& sampler, LightSample& sample)
+{
+	//aim from the offset origin, otherwise the shifted shadow ray clips the light before the sampled point
+	vec3<f32> origin = P + N * 0.01f;
+
+	f32 uSelect = sampler.get1D(SampleDimension::LightSelect);
+	vec2<f32> u = sampler.get2D(SampleDimension::LightPoint);
+	f32 environmentProbability = environment_probability();
+	if (uSelect < environmentProbability)
+	{
+		vec3<f32> wi;
+		f32 pdf;
+		//uSelect has too few bits left to pick among millions of pixels
+		vec3<f32> radiance = environmentMap.sample(sampler.get2D(SampleDimension::LightTable), u, wi, pdf);
+		pdf *= environmentProbability;
+		if (pdf <= 0.0f || dot(wi, N) <= 0.0f)
+			return false;
+		sample.shadowRay.origin = origin;
+		sample.shadowRay.direction = wi;
+		sample.radiance = radiance / pdf;
+		sample.pdf = pdf;
+		return true;
+	}
+	uSelect = (uSelect - environmentProbability) / (1.0f - environmentProbability);
+
+	f32 pmf;
+	const Primitive* light = bvhScene.lightList.sample(uSelect, origin, N, pmf);
+	if (!light)
+		return false;
+	pmf *= 1.0f - environmentProbability;
+	vec3<f32> lightP, lightN;
+	light->samplePoint(u.x, u.y, lightP, lightN);
+
+	vec3<f32> d = lightP - origin;
+	f32 dist2 = dot(d, d);
+	if (dist2 <= 0.0f)
+		return false;
+	f32 dist = sqrtf(dist2);
+	vec3<f32> wi = d / dist;
+
+	f32 cosSurface = dot(wi, N);
+	f32 cosLight = fabsf(dot(wi, lightN));
+	f32 lightPdf = light_pdf(light, pmf, dist2, cosLight);
+	if (cosSurface <= 0.0f || lightPdf <= 0.0f)
+		return false;
+
+	sample.shadowRay.origin = origin;
+	sample.shadowRay.direction = wi;
+	//stop short of the light itself
+	sample.shadowRay.tMax = dist * 0.999f;
+
+	sample.radiance = light->material.emissive / lightPdf;
+	sample.pdf = lightPdf;
+	return true;
+}
+
+vec3<f32> emitted_radiance(const ray& ray, const HitInfo& hitInfo, f32 bsdfPdf, const vec3<f32>& prevNormal)
+{
+	const vec3<f32>& emissive = hitInfo.material.emissive;
+	if (luminance(emissive) <= 0.0f)
+		return vec3<f32>(0.0f);
+
+	f32 weight = 1.0f;
+	if (nextEventEstimation && bsdfPdf > 0.0f && hitInfo.primitive)
+	{
+		f32 pmf = bvhScene.lightList.pmf(hitInfo.primitive, ray.origin, prevNormal) * (1.0f - environment_probability());
+		f32 lightPdf = light_pdf(hitInfo.primitive, pmf, hitInfo.t * hitInfo.t, fabsf(dot(hitInfo.normal, ray.direction)));
+		weight = power_heuristic(bsdfPdf, lightPdf);
+	}
+	return emissive * weight;
+}
+
+bool next_event_enabled(int depth)
+{
+	return nextEventEstimation && (!bvhScene.lightList.empty() || !environmentMap.table.empty()) && depth + 1 < maxDepth;
+}
+
 void closest_hit(const ray& ray, Payload& payload)
 {
-	vec3<f32> N = payload.hitInfo.normal;
-	vec3<f32> P = ray.origin + ray.direction * payload.hitInfo.t;
-	vec3<f32> ffnormal = faceforward(ray.direction * -1, N);
-	vec3<f32> wi;
-	f32 pdf;
-	cosine_sample_hemisphere(rnd(payload.seed), rnd(payload.seed), wi, pdf);
-	wi = tangent_to_world(wi, ffnormal);
+	const HitInfo& hitInfo = payload.hitInfo;
+	const Material& material = hitInfo.material;
+	vec3<f32> N = hitInfo.normal;
+	vec3<f32> P = ray.origin + ray.direction * hitInfo.t;
+	vec3<f32> wo = ray.direction * -1;
+	vec3<f32> ffnormal = faceforward(wo, N);
+	payload.sampler.startBounce(payload.depth);
+
+	payload.radiance += emitted_radiance(ray, hitInfo, payload.bsdfPdf, payload.normal);
+
+	if (!bsdf_is_delta(material.type) && next_event_enabled(payload.depth))
+	{
+		LightSample lightSample;
+		if (sample_direct_light(P, ffnormal, payload.sampler, lightSample) && !closest_hit_occlusion(lightSample.shadowRay))
+			payload.radiance += lightSample.radiance * light_sample_weight(material, wo, lightSample.shadowRay.direction, ffnormal, lightSample.pdf);
+	}
+
+	BsdfSample bsdf;
+	if (!sample_bsdf(hitInfo, wo, ffnormal, payload.sampler, bsdf))
+	{
+		payload.done = true;
+		return;
+	}
+	payload.attenuation *= bsdf.weight;
+	payload.bsdfPdf = bsdf.pdf;
+	payload.normal = ffnormal;
+	payload.direction = bsdf.wi;
+	//refracted rays leave from the far side
+	payload.origin = P + faceforward(bsdf.wi, ffnormal) * 0.01f;
+	payload.coneWidth = ray.coneWidth + ray.coneSpread * payload.hitInfo.t;
+	payload.coneSpread = ray.coneSpread + voxelLodBounceSpread;
+}
+
+vec3<f32> miss_radiance(const ray& ray, f32 bsdfPdf)
+{
+	if (!environmentMap.empty())
+	{
+		vec3<f32> radiance = environmentMap.radiance(ray.direction);
+		if (nextEventEstimation && bsdfPdf > 0.0f)
+			radiance *= power_heuristic(bsdfPdf, environment_probability() * environmentMap.pdf(ray.direction));
+		return radiance;
+	}
 
-	payload.attenuation *= payload.hitInfo.material.color;
-	payload.radiance += payload.hitInfo.material.emissive;
-	payload.direction = wi;
-	payload.origin = P + ffnormal * 0.01f;
+	auto t = 0.5f * (ray.direction.y + 1.0f);
+	return (1.0f - t) * vec3<f32>(1.0f, 1.0f, 1.0f) + t * vec3<f32>(0.5f, 0.7f, 1.0f);
 }
 
 void miss_hit(const ray& ray, Payload& payload)
 {
-	auto t = 0.5f * (ray.direction.y + 1.0f);
-	payload.radiance = (1.0f - t) * vec3<f32>(1.0f, 1.0f, 1.0f) + t * vec3<f32>(0.5f, 0.7f, 1.0f);
+	payload.radiance = miss_radiance(ray, payload.bsdfPdf);
 	payload.done = true;
 }
 
+bool closest_hit_intersect(const ray& ray, HitInfo& hitInfo)
+{
+	RAYS_TRACED++;
+	return bvhScene.rayIntersect(ray, hitInfo);
+}
+
 bool closest_hit_occlusion(const ray& ray)
 {
-	return false;
+	RAYS_TRACED++;
+	return bvhScene.rayOccluded(ray);
 }
@@ -1,16 +1,40 @@
 ﻿#pragma once
 
 #include <functional>
+#include <string>
+#include <chrono>
 #include "../Camera.h"
 #include "Bvh.h"
+#include "Aov.h"
+#include "PostProcess.h"
+#include "Denoise.h"
+#include "TileScheduler.h"
+#include "TraversalStats.h"
+#include "Sampler.h"
+#include "Bsdf.h"
+#include "EnvironmentMap.h"
 
+//AOV shown by the u32 render output
 enum struct RenderOutput
 {
 	Beaut,
 	Albedo,
 	Normal,
 	Depth,
-	Barycentric
+	Barycentric,
+	PrimitiveId,
+	SampleCount,
+	//traversal work heatmap, needs a RAYTRACE_STATS build
+	Cost
+};
+
+//path tracer loop
+enum struct Integrator
+{
+	//whole path of one sample per call
+	Megakernel,
+	//bounce stages over batches of a tile's samples, see Wavefront
+	Wavefront
 };
 
 namespace RayTracer
@@ -19,14 +43,89 @@ namespace RayTracer
 
 	extern BVHAccel bvhScene;
 
+	//light of rays leaving the scene, a light next to the emitters for NEE, the sky gradient while empty
+	extern EnvironmentMap environmentMap;
+
 	extern RenderOutput renderOutput;
 
+	extern Integrator integrator;
+
+	//aov_bit set filled by the u32 render(), the renderOutput plane is always added
+	extern u32 aovMask;
+
+	//beauty to display, applied after tracing
+	extern PostProcessSettings postProcess;
+
+	//filter the displayed beauty before the post process, adds the guide planes to the render
+	extern bool denoiseOutput;
+
+	extern DenoiseSettings denoiseSettings;
+
 	extern int maxDepth;
 
+	//connect every bounce to a sampled emitter, combined with BSDF sampling by MIS
+	extern bool nextEventEstimation;
+
+	//bounce from which paths are terminated by throughput, negative disables
+	extern int russianRouletteDepth;
+
 	extern int samplesPerPixel;
 
+	//accumulate samplesPerFrame samples per render() call until samplesPerPixel
+	extern bool progressive;
+
+	extern int samplesPerFrame;
+
+	//stop a pixel once the relative error of its mean falls under adaptiveThreshold
+	extern bool adaptiveSampling;
+
+	extern f32 adaptiveThreshold;
+
+	extern int adaptiveMinSamples;
+
+	extern int adaptiveMaxSamples;
+
+	//random numbers of camera jitter, light sampling, BSDF sampling and russian roulette
+	extern SamplerType samplerType;
+
+	//render workers, 0 = size of the shared thread pool
+	extern u32 threadCount;
+
+	//progressive passes save the accumulation here every checkpointSeconds, empty disables
+	extern std::string checkpointFile;
+
+	extern f32 checkpointSeconds;
+
+	//ray cone spread added per diffuse bounce, drives voxel LOD of secondary rays
+	extern f32 voxelLodBounceSpread;
+
+	/**
+	* Progress of a render() pass in percent, called from one reporter thread at a fixed rate,
+	* never concurrently and never from the render workers. The last call of a pass reports 100.
+	*/
 	extern std::function<void(float)> renderProgressCallback;
 
+	struct RenderStats
+	{
+		//samples traced by the last render() call
+		u64 samples = 0;
+		//closest hit and shadow rays of those samples
+		u64 rays = 0;
+		//traversal work of those rays, RAYTRACE_STATS builds only
+		TraversalStats traversal;
+		//against a fixed sample count per pixel, negative when noisy pixels took more
+		i64 samplesSaved = 0;
+		//render_until only
+		u32 passes = 0;
+		f64 seconds = 0.0;
+		//accumulated samples per pixel after the call
+		u32 minSpp = 0;
+		u32 maxSpp = 0;
+		f32 meanSpp = 0.0f;
+	};
+
+	extern RenderStats renderStats;
+
 	enum struct PTFlag
 	{
 		None,
@@ -35,17 +134,49 @@ namespace RayTracer
 
 	struct Payload
 	{
-		u32 seed;
+		Sampler sampler;
 		vec3<f32> origin;
 		vec3<f32> direction;
 		vec3<f32> radiance;
 		vec3<f32> attenuation;
+		f32 coneWidth = 0.0f;
+		f32 coneSpread = 0.0f;
+		//solid angle pdf of the sampled direction, 0 = camera ray or specular bounce
+		f32 bsdfPdf = 0.0f;
+		//shading normal at the origin of the ray, light selection depends on it
+		vec3<f32> normal;
+		//bounce index of the ray being traced
+		int depth = 0;
+		//missed the scene, or the BSDF found no direction to continue
 		bool done = false;
 		HitInfo hitInfo;
 	};
 
+	//features of the first hit of one camera sample
+	struct PrimaryHit
+	{
+		bool hit = false;
+		vec3<f32> albedo;
+		//faces the camera
+		vec3<f32> normal;
+		vec3<f32> bary;
+		f32 depth = 0.0f;
+		i32 primitiveId = -1;
+	};
+
+	//light sample of a vertex, counts once shadowRay is unoccluded
+	struct LightSample
+	{
+		ray shadowRay;
+		//Le / pdf, the BSDF and its MIS weight not applied
+		vec3<f32> radiance;
+		//solid angle pdf of the light sample
+		f32 pdf = 0.0f;
+	};
+
 	struct Param
 	{
+		//frames accumulated before this one
 		u32 frameCount = 0;
 		f32 cameraNdcXscale = 1.0f;
 		f32 cameraNdcYscale = 1.0f;
@@ -58,9 +189,70 @@ namespace RayTracer
 
 void render(i32 width, i32 height, u32* buffer, bool parallel = true);
 
-vec3<f32> ray_gen_single(i32 x, i32 y, i32 width, i32 height, const RayTracer::Param& param);
+/**
+* Camera of the next render, taken from RayTracer::camera
+*/
+RayTracer::Param camera_param();
+
+/**
+* One pass writing every plane in aovs.mask, resized to width x height.
+* Features are averaged over the same camera samples as beauty, taken from their first hit.
+*/
+void render(i32 width, i32 height, AovBuffers& aovs, bool parallel = true);
+
+/**
+* Pixels of region of a width x height frame, aovs is resized to the region and row 0 is region.y0.
+* Samples are the ones the full frame render takes for these pixels, regions stitch into the same image.
+* @param param camera, camera_param() or one received from another process
+*/
+void render_region(i32 width, i32 height, const Tile& region, const RayTracer::Param& param, AovBuffers& aovs, bool parallel = true);
+
+/**
+* Planes the u32 render output is made from under the current settings
+*/
+u32 display_mask();
+
+/**
+* Pack the renderOutput plane of aovs into buffer, as the u32 render() does
+*/
+void display_aov(const AovBuffers& aovs, u32* buffer, bool parallel = true);
+
+/**
+* Float planes behind the last u32 render() or render_until(), beauty is not denoised
+*/
+const AovBuffers& render_aovs();
+
+/**
+* Progressive passes of samplesPerFrame until the deadline, at least one. A pass that would overrun
+* the deadline, judged by the last pass time, is not started.
+* Accumulation carries over between calls while the view is unchanged, reset_accumulation() first for a fresh estimate.
+*/
+const RayTracer::RenderStats& render_until(i32 width, i32 height, u32* buffer, std::chrono::steady_clock::time_point deadline, bool parallel = true);
+
+/**
+* Drop the progressive accumulation, camera and scene changes reset it automatically.
+*/
+void reset_accumulation();
 
-vec3<f32> ray_gen(i32 x, i32 y, i32 width, i32 height, const RayTracer::Param& param);
+/**
+* Save the progressive accumulation: float sums, per pixel sample counts and statistics, feature sums.
+* Samplers start from pixel and sample index, the counts are the RNG stream positions.
+* Written with write_file_atomic.
+*/
+bool save_checkpoint(const char* filename);
+
+/**
+* Restore a saved accumulation, the next progressive render continues it when size, camera, planes and scene
+* match the saved render, and ends bit-identical to a render that never stopped.
+* @return false for a missing file, another scene or environment map, or path and sampling settings that differ from the saved ones
+*/
+bool load_checkpoint(const char* filename);
+
+int accumulated_samples();
+
+bool accumulation_done();
+
+vec3<f32> ray_gen_sample(i32 x, i32 y, i32 width, i32 height, const RayTracer::Param& param, u32 sampleIndex, RayTracer::PrimaryHit* primary = nullptr);
 
 void trace_ray(ray& ray, const BVHAccel& scene, RayTracer::Payload& payload);
 
@@ -68,4 +260,39 @@ void closest_hit(const ray& ray, RayTracer::Payload& payload);
 
 void miss_hit(const ray& ray, RayTracer::Payload& payload);
 
+bool closest_hit_intersect(const ray& ray, HitInfo& hitInfo);
+
 bool closest_hit_occlusion(const ray& ray);
+
+//path stages shared by ray_gen_sample and the wavefront integrator
+
+ray camera_ray(i32 x, i32 y, i32 width, i32 height, const RayTracer::Param& param, Sampler& sampler);
+
+void record_primary_hit(const ray& ray, const HitInfo& hitInfo, const RayTracer::Param& param, RayTracer::PrimaryHit& primary);
+
+/**
+* Emission found by BSDF sampling, weighted against the light sample taken at the previous vertex
+* @param prevNormal shading normal at the origin of the ray
+*/
+vec3<f32> emitted_radiance(const ray& ray, const HitInfo& hitInfo, f32 bsdfPdf, const vec3<f32>& prevNormal);
+
+/**
+* A light sample adds one segment, none on the last bounce to keep the same path length as BSDF sampling
+*/
+bool next_event_enabled(int depth);
+
+/**
+* @return false when no light is reachable and there is nothing to test
+*/
+bool sample_direct_light(const vec3<f32>& P, const vec3<f32>& N, Sampler& sampler, RayTracer::LightSample& sample);
+
+/**
+* @return false when the path is terminated, survivors have attenuation reweighted
+*/
+bool russian_roulette(vec3<f32>& attenuation, int depth, Sampler& sampler);
+
+/**
+* Environment light of a ray leaving the scene, weighted against the light sample of its origin
+* @param bsdfPdf solid angle pdf of the ray, 0 for camera rays and specular bounces
+*/
+vec3<f32> miss_radiance(const ray& ray, f32 bsdfPdf);
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "../KDMath.h"
+#include "../Util.h"
+#include "BlueNoise.h"
+
+enum struct SamplerType
+{
+	//LCG stream seeded per pixel and sample, every draw independent
+	Random,
+	//Owen-scrambled Sobol, stratified per pixel in every dimension
+	Sobol,
+	//rank-1 lattice shifted per pixel by a blue-noise tile, neighbouring pixels get well spread
+	//samples so the error at low sample counts is high frequency noise a denoiser removes easily
+	BlueNoise
+};
+
+//what a path vertex draws, each one is its own scrambled sequence per bounce
+enum struct SampleDimension : u32
+{
+	Camera,
+	LightSelect,
+	LightPoint,
+	//pixel of the environment map, both halves of one 48 bit number
+	LightTable,
+	Bsdf,
+	//which lobe of a layered or dielectric BSDF
+	BsdfLobe,
+	RussianRoulette,
+	Count
+};
+
+/**
+* Hash-based Owen scrambling of the first two Sobol dimensions (Burley 2020), padded to any number of
+* dimensions: every (bounce, SampleDimension) slot shuffles the sample index and scrambles the points
+* with its own per pixel seeds. Samples 0..n-1 of a pixel are stratified in each slot, best at powers of two.
+* BlueNoise walks the R2 lattice (golden ratio in 1D) and rotates it toroidally by the blue-noise rank of
+* the pixel, the tile is read at a different offset per slot so the dimensions stay decorrelated.
+*/
+struct Sampler
+{
+	void start(SamplerType type, i32 x, i32 y, i32 width, u32 sampleIndex)
+	{
+		u32 pixel = u32(x + y * width);
+		this->type = type;
+		//sample indices start at 1, the sequence at 0
+		index = sampleIndex - 1;
+		base = 0;
+		if (type == SamplerType::Random)
+			seed = rnd_init(pixel, sampleIndex);
+		else if (type == SamplerType::Sobol)
+			seed = rnd_init(pixel, 0x9e3779b9u);
+		else
+			seed = (u32(x) % BLUE_NOISE_SIZE) | (u32(y) % BLUE_NOISE_SIZE) << 16;
+	}
+
+	//dimensions drawn from here on belong to this bounce
+	void startBounce(int depth)
+	{
+		base = 1 + u32(depth) * (u32(SampleDimension::Count) - 1);
+	}
+
+	f32 get1D(SampleDimension dimension)
+	{
+		if (type == SamplerType::Random)
+			return rnd(seed);
+		if (type == SamplerType::BlueNoise)
+			return to_unit(index * 0x9e3779b9u + blueNoiseShift(slot(dimension), 0));
+		u32 s = slotSeed(dimension);
+		u32 i = nested_uniform_scramble(index, s);
+		return to_unit(nested_uniform_scramble(reverse_bits(i), hash(s + 1)));
+	}
+
+	vec2<f32> get2D(SampleDimension dimension)
+	{
+		if (type == SamplerType::Random)
+		{
+			f32 u = rnd(seed);
+			return vec2<f32>(u, rnd(seed));
+		}
+		if (type == SamplerType::BlueNoise)
+		{
+			u32 s = slot(dimension);
+			return vec2<f32>(to_unit(index * 0xc13fa9a9u + blueNoiseShift(s, 0)),
+				to_unit(index * 0x91e10da6u + blueNoiseShift(s, 1)));
+		}
+		u32 s = slotSeed(dimension);
+		u32 i = nested_uniform_scramble(index, s);
+		return vec2<f32>(to_unit(nested_uniform_scramble(reverse_bits(i), hash(s + 1))),
+			to_unit(nested_uniform_scramble(sobol_dimension1(i), hash(s + 2))));
+	}
+
+private:
+	SamplerType type = SamplerType::Sobol;
+	u32 index = 0;
+	u32 base = 0;
+	//LCG state of Random, pixel hash of Sobol, tile x | y << 16 of BlueNoise
+	u32 seed = 0;
+
+	u32 slot(SampleDimension dimension) const
+	{
+		return dimension == SampleDimension::Camera ? 0 : base + u32(dimension) - 1;
+	}
+
+	u32 slotSeed(SampleDimension dimension) const
+	{
+		return hash(seed ^ (slot(dimension) * 0x9e3779b9u));
+	}
+
+	//rank of the pixel in the tile moved by a per slot offset, spread over the 32 bit circle
+	u32 blueNoiseShift(u32 slot, u32 axis) const
+	{
+		u32 offset = hash(slot * 2 + axis);
+		return blue_noise((seed & 0xffff) + offset, (seed >> 16) + (offset >> 16)) << 20;
+	}
+
+	//lowbias32, cheap enough to run per draw
+	static u32 hash(u32 x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	static u32 reverse_bits(u32 v)
+	{
+		v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+		v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+		v = ((v >> 4) & 0x0f0f0f0fu) | ((v & 0x0f0f0f0fu) << 4);
+		v = ((v >> 8) & 0x00ff00ffu) | ((v & 0x00ff00ffu) << 8);
+		return (v >> 16) | (v << 16);
+	}
+
+	//random permutation of the bits where each bit only depends on lower ones, owen scrambling in reversed order
+	static u32 laine_karras_permutation(u32 x, u32 seed)
+	{
+		x ^= x * 0x3d20adeau;
+		x += seed;
+		x *= (seed >> 16) | 1;
+		x ^= x * 0x05526c56u;
+		x ^= x * 0x53a22864u;
+		return x;
+	}
+
+	static u32 nested_uniform_scramble(u32 x, u32 seed)
+	{
+		return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+	}
+
+	//second Sobol dimension, primitive polynomial x + 1, direction numbers v(k) = v(k-1) ^ v(k-1) >> 1
+	static u32 sobol_dimension1(u32 index)
+	{
+		u32 result = 0;
+		for (u32 v = 1u << 31; index; index >>= 1, v ^= v >> 1)
+		{
+			if (index & 1)
+				result ^= v;
+		}
+		return result;
+	}
+
+	//top 24 bits, stays under 1
+	static f32 to_unit(u32 x)
+	{
+		return f32(x >> 8) * (1.0f / 16777216.0f);
+	}
+};
@@ -13,3 +13,56 @@ void cosine_sample_hemisphere(float r1, float r2, vec3<f32>& p, float& pdf)
 
 	pdf = p.z * F32_1_FRAC_PI;
 }
+
+bool AliasTable::build(const std::vector<f32>& weights)
+{
+	probability.clear();
+	alias.clear();
+	pmf.clear();
+	f64 sum = 0.0;
+	for (f32 w : weights)
+		sum += w;
+	if (sum <= 0.0)
+		return false;
+
+	size_t n = weights.size();
+	probability.resize(n);
+	alias.resize(n);
+	pmf.resize(n);
+
+	//Vose: pair every under-full bucket with an over-full one that tops it up
+	std::vector<f64> scaled(n);
+	std::vector<u32> small, large;
+	for (size_t i = 0; i < n; i++)
+	{
+		pmf[i] = f32(weights[i] / sum);
+		scaled[i] = weights[i] / sum * f64(n);
+		(scaled[i] < 1.0 ? small : large).push_back(u32(i));
+	}
+	while (!small.empty() && !large.empty())
+	{
+		u32 s = small.back();
+		small.pop_back();
+		u32 l = large.back();
+		probability[s] = f32(scaled[s]);
+		alias[s] = l;
+		scaled[l] -= 1.0 - scaled[s];
+		if (scaled[l] < 1.0)
+		{
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+	//left overs are full up to rounding
+	for (u32 i : large)
+	{
+		probability[i] = 1.0f;
+		alias[i] = i;
+	}
+	for (u32 i : small)
+	{
+		probability[i] = 1.0f;
+		alias[i] = i;
+	}
+	return true;
+}
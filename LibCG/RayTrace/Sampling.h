@@ -1,5 +1,46 @@
 ﻿#pragma once
 
+#include <vector>
 #include "../KDMath.h"
 
 void cosine_sample_hemisphere(float r1, float r2, vec3<f32>& p, float& pdf);
+
+/**
+* MIS weight of strategy a against b, power heuristic with beta = 2
+*/
+inline f32 power_heuristic(f32 pdfA, f32 pdfB)
+{
+	f32 a = pdfA * pdfA;
+	f32 b = pdfB * pdfB;
+	return a + b > 0.0f ? a / (a + b) : 0.0f;
+}
+
+/**
+* Walker's alias method, picks index i with probability weight[i] / sum in O(1) from one uniform number
+*/
+struct AliasTable
+{
+	//chance of keeping the bucket instead of jumping to its alias
+	std::vector<f32> probability;
+	std::vector<u32> alias;
+	//normalized weights
+	std::vector<f32> pmf;
+
+	//false when all weights are zero, the table is left empty
+	bool build(const std::vector<f32>& weights);
+
+	bool empty() const { return pmf.empty(); }
+
+	/**
+	* The bucket and the bucket or alias coin come from one number, u.y extends the 24 bits of u.x
+	* to 48 so a table of 2^24 buckets still leaves 24 bits for the coin
+	* @param u two numbers in [0, 1) with 24 bits each, as the samplers make them
+	*/
+	u32 sample(const vec2<f32>& u) const
+	{
+		u32 n = u32(pmf.size());
+		f64 scaled = (f64(u.x) + f64(u.y) * (1.0 / 16777216.0)) * f64(n);
+		u32 i = min(u32(scaled), n - 1);
+		return scaled - f64(i) < f64(probability[i]) ? i : alias[i];
+	}
+};
@@ -0,0 +1,123 @@
+#include "TileScheduler.h"
+#include "../ThreadPool.h"
+
+#include <vector>
+#include <deque>
+#include <mutex>
+
+namespace
+{
+	struct TileQueue
+	{
+		std::mutex mutex;
+		std::deque<u32> tiles;
+	};
+
+	u32 morton_compact(u32 v)
+	{
+		v &= 0x55555555;
+		v = (v | (v >> 1)) & 0x33333333;
+		v = (v | (v >> 2)) & 0x0f0f0f0f;
+		v = (v | (v >> 4)) & 0x00ff00ff;
+		v = (v | (v >> 8)) & 0x0000ffff;
+		return v;
+	}
+}
+
+u32 tile_worker_count(u32 threadCount)
+{
+	return threadCount == 0 ? thread_pool_size() : threadCount;
+}
+
+void schedule_tiles(i32 width, i32 height, i32 tileSize, const std::function<void(const Tile& tile, u32 worker)>& func, u32 threadCount)
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	u32 tilesX = (width + tileSize - 1) / tileSize;
+	u32 tilesY = (height + tileSize - 1) / tileSize;
+	u32 side = 1;
+	while (side < tilesX || side < tilesY)
+		side <<= 1;
+
+	auto tileAt = [&](u32 code)
+	{
+		Tile tile;
+		tile.x0 = morton_compact(code) * tileSize;
+		tile.y0 = morton_compact(code >> 1) * tileSize;
+		tile.x1 = min(tile.x0 + tileSize, width);
+		tile.y1 = min(tile.y0 + tileSize, height);
+		return tile;
+	};
+	auto inside = [&](u32 code)
+	{
+		return morton_compact(code) < tilesX && morton_compact(code >> 1) < tilesY;
+	};
+
+	threadCount = tile_worker_count(threadCount);
+
+	if (threadCount == 1)
+	{
+		for (u32 code = 0; code < side * side; code++)
+		{
+			if (inside(code))
+				func(tileAt(code), 0);
+		}
+		return;
+	}
+
+	//contiguous Morton ranges per worker keep neighbouring tiles on one thread
+	u32 tileCount = tilesX * tilesY;
+	std::vector<TileQueue> queues(threadCount);
+	u32 tileIndex = 0;
+	for (u32 code = 0; code < side * side; code++)
+	{
+		if (!inside(code))
+			continue;
+		queues[u64(tileIndex) * threadCount / tileCount].tiles.push_back(code);
+		tileIndex++;
+	}
+
+	auto worker = [&](u32 self)
+	{
+		while (true)
+		{
+			u32 code;
+			bool found = false;
+			{
+				TileQueue& own = queues[self];
+				std::lock_guard<std::mutex> lock(own.mutex);
+				if (!own.tiles.empty())
+				{
+					code = own.tiles.front();
+					own.tiles.pop_front();
+					found = true;
+				}
+			}
+
+			//steal from the back of the other queues
+			for (u32 i = 1; i < threadCount && !found; i++)
+			{
+				TileQueue& victim = queues[(self + i) % threadCount];
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (!victim.tiles.empty())
+				{
+					code = victim.tiles.back();
+					victim.tiles.pop_back();
+					found = true;
+				}
+			}
+
+			if (!found)
+				return;
+			func(tileAt(code), self);
+		}
+	};
+
+	//worker indices stay logical, a pool smaller than threadCount runs several of them one after another
+	TaskGroup group;
+	for (u32 i = 1; i < threadCount; i++)
+		group.run([&worker, i]() { worker(i); });
+	worker(0);
+	group.wait();
+}
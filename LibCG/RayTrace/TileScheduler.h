@@ -0,0 +1,24 @@
+#pragma once
+
+#include <functional>
+#include "../KDMath.h"
+
+struct Tile
+{
+	i32 x0, y0;
+	i32 x1, y1;
+};
+
+/**
+* @param threadCount 0 = size of the shared thread pool
+* @return number of workers schedule_tiles will run with
+*/
+u32 tile_worker_count(u32 threadCount = 0);
+
+/**
+* Split the image into tiles in Morton order and render them on tasks of the shared thread pool,
+* each worker owns a deque of tiles and steals from the others when it runs dry.
+* func gets the index of the worker running it, in [0, tile_worker_count(threadCount)).
+* @param threadCount 0 = size of the shared thread pool
+*/
+void schedule_tiles(i32 width, i32 height, i32 tileSize, const std::function<void(const Tile& tile, u32 worker)>& func, u32 threadCount = 0);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../KDMath.h"
+
+//build with RAYTRACE_STATS=1 to count traversal work, otherwise the counters compile to nothing
+#ifndef RAYTRACE_STATS
+#define RAYTRACE_STATS 0
+#endif
+
+struct TraversalStats
+{
+	//BVH nodes and voxel tree nodes entered
+	u64 nodes = 0;
+	//ray-primitive tests
+	u64 primitives = 0;
+	//path vertices, hits that were shaded
+	u64 bounces = 0;
+
+	TraversalStats& operator+=(const TraversalStats& other)
+	{
+		nodes += other.nodes;
+		primitives += other.primitives;
+		bounces += other.bounces;
+		return *this;
+	}
+
+	TraversalStats operator-(const TraversalStats& other) const
+	{
+		TraversalStats stats;
+		stats.nodes = nodes - other.nodes;
+		stats.primitives = primitives - other.primitives;
+		stats.bounces = bounces - other.bounces;
+		return stats;
+	}
+
+	//nodes and primitive tests, what the Cost AOV shows
+	u64 work() const { return nodes + primitives; }
+};
+
+namespace RayTracer
+{
+	constexpr bool TRAVERSAL_STATS = RAYTRACE_STATS != 0;
+
+	//counters of the calling thread, plain adds, read by the same thread around its work
+	inline thread_local TraversalStats traversalStats;
+}
+
+inline void count_node()
+{
+	if constexpr (RayTracer::TRAVERSAL_STATS)
+		RayTracer::traversalStats.nodes++;
+}
+
+inline void count_primitive()
+{
+	if constexpr (RayTracer::TRAVERSAL_STATS)
+		RayTracer::traversalStats.primitives++;
+}
+
+inline void count_bounce()
+{
+	if constexpr (RayTracer::TRAVERSAL_STATS)
+		RayTracer::traversalStats.bounces++;
+}
+
+//counters of the calling thread, all zero without RAYTRACE_STATS
+inline TraversalStats traversal_stats()
+{
+	if constexpr (RayTracer::TRAVERSAL_STATS)
+		return RayTracer::traversalStats;
+	else
+		return TraversalStats();
+}
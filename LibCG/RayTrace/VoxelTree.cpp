@@ -0,0 +1,306 @@
+#include "VoxelTree.h"
+#include "TraversalStats.h"
+#include <algorithm>
+#include <array>
+
+static inline u32 popcount64(u64 v)
+{
+	v = v - ((v >> 1) & 0x5555555555555555ull);
+	v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+	v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+	return (u32)((v * 0x0101010101010101ull) >> 56);
+}
+
+static inline vec3<f32> unpack_color(u32 color)
+{
+	return vec3<f32>((color & 0xff) / 255.0f, ((color >> 8) & 0xff) / 255.0f, ((color >> 16) & 0xff) / 255.0f);
+}
+
+static inline u32 pack_color(const vec3<f32>& color)
+{
+	u32 r = u32(min(max(color.x, 0.0f), 1.0f) * 255.0f + 0.5f);
+	u32 g = u32(min(max(color.y, 0.0f), 1.0f) * 255.0f + 0.5f);
+	u32 b = u32(min(max(color.z, 0.0f), 1.0f) * 255.0f + 0.5f);
+	return 0xff000000 | (b << 16) | (g << 8) | r;
+}
+
+//children bits covered by each 2x2x2 group of a 4x4x4 node
+static const std::array<u64, 8> GROUP_MASKS = []()
+{
+	std::array<u64, 8> masks{};
+	for (u32 group = 0; group < 8; group++)
+	{
+		u32 gx = group & 1, gy = (group >> 1) & 1, gz = (group >> 2) & 1;
+		for (u32 k = 0; k < 2; k++)
+			for (u32 j = 0; j < 2; j++)
+				for (u32 i = 0; i < 2; i++)
+					masks[group] |= 1ull << ((gx * 2 + i) | ((gy * 2 + j) << 2) | ((gz * 2 + k) << 4));
+	}
+	return masks;
+}();
+
+struct VoxelTree::TraversalRay
+{
+	vec3<f32> o;
+	vec3<f32> d;
+	vec3<f32> invD;
+	f32 coneWidth;
+	f32 coneSpread;
+	u32 minLod;
+	f32 tMin;
+};
+
+//interleave 2 bits of x,y,z per level, root level in the highest bits
+static u64 voxel_key(const Voxel& voxel, u32 levels)
+{
+	u64 key = 0;
+	for (int level = levels - 1; level >= 0; level--)
+	{
+		u32 shift = level * 2;
+		u64 digit = ((voxel.x >> shift) & 3) | (((voxel.y >> shift) & 3) << 2) | (((voxel.z >> shift) & 3) << 4);
+		key = (key << 6) | digit;
+	}
+	return key;
+}
+
+void VoxelTree::build(std::vector<Voxel>& input)
+{
+	nodes.clear();
+	voxels.clear();
+	nodeColors.clear();
+	levels = 0;
+	if (input.empty())
+		return;
+
+	u32 maxCoord = 0;
+	for (auto& voxel : input)
+		maxCoord = max(maxCoord, max(voxel.x, max(voxel.y, voxel.z)));
+
+	levels = 1;
+	while (levels < 10 && (1ull << (2 * levels)) <= maxCoord)
+		levels++;
+
+	//sort by key once instead of recomputing keys in the comparator
+	std::vector<std::pair<u64, u32>> order(input.size());
+	for (size_t i = 0; i < input.size(); i++)
+		order[i] = { voxel_key(input[i], levels), (u32)i };
+	std::sort(order.begin(), order.end());
+
+	std::vector<Voxel> sorted(input.size());
+	std::vector<u64> keys(input.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		keys[i] = order[i].first;
+		sorted[i] = input[order[i].second];
+	}
+	input.swap(sorted);
+
+	nodes.reserve(input.size() / 8 + 1);
+	voxels.reserve(input.size());
+	nodes.emplace_back();
+	nodeColors.emplace_back();
+	buildNode(0, input, keys, 0, input.size(), levels - 1);
+}
+
+void VoxelTree::buildNode(u32 node, const std::vector<Voxel>& input, const std::vector<u64>& keys, size_t start, size_t end, u32 height)
+{
+	u32 shift = height * 6;
+
+	//keys are sorted, children come out in bit order
+	u64 mask = 0;
+	for (size_t i = start; i < end; i++)
+		mask |= 1ull << ((keys[i] >> shift) & 63);
+	nodes[node].childMask = mask;
+
+	if (height == 0)
+	{
+		nodes[node].childIndex = (u32)voxels.size();
+		vec3<f32> sum;
+		for (size_t i = start; i < end; i++)
+		{
+			//duplicate voxels, last one wins
+			if (i + 1 < end && keys[i + 1] == keys[i])
+				continue;
+			voxels.push_back(input[i].index);
+			sum += unpack_color(palette[input[i].index - 1]);
+		}
+		nodeColors[node] = pack_color(sum / f32(popcount64(mask)));
+		return;
+	}
+
+	u32 first = (u32)nodes.size();
+	u32 count = popcount64(mask);
+	nodes[node].childIndex = first;
+	nodes.resize(first + count);
+	nodeColors.resize(first + count);
+
+	u32 child = first;
+	size_t groupStart = start;
+	for (size_t i = start + 1; i <= end; i++)
+	{
+		if (i == end || ((keys[i] >> shift) & 63) != ((keys[groupStart] >> shift) & 63))
+		{
+			buildNode(child++, input, keys, groupStart, i, height - 1);
+			groupStart = i;
+		}
+	}
+
+	//mip: average of the children
+	vec3<f32> sum;
+	for (u32 i = first; i < first + count; i++)
+		sum += unpack_color(nodeColors[i]);
+	nodeColors[node] = pack_color(sum / f32(count));
+}
+
+bool VoxelTree::rayIntersect(const ray& ray, f32& t, vec3<f32>& normal, vec3<f32>& color, u32 minLod) const
+{
+	if (nodes.empty())
+		return false;
+
+	TraversalRay r;
+	r.o = ray.origin - origin;
+	r.d = ray.direction;
+	for (int i = 0; i < 3; i++)
+		r.invD[i] = r.d[i] != 0.0f ? 1.0f / r.d[i] : F32_INF;
+	r.coneWidth = ray.coneWidth;
+	r.coneSpread = ray.coneSpread;
+	r.minLod = minLod;
+	r.tMin = ray.tMin;
+
+	//root bounds clipped to the ray interval
+	f32 size = f32(1ull << (2 * levels));
+	f32 tNear = ray.tMin;
+	f32 tFar = ray.tMax;
+	int entryAxis = -1;
+	for (int i = 0; i < 3; i++)
+	{
+		if (r.d[i] == 0.0f)
+		{
+			if (r.o[i] < 0.0f || r.o[i] > size)
+				return false;
+			continue;
+		}
+		f32 t0 = (0.0f - r.o[i]) * r.invD[i];
+		f32 t1 = (size - r.o[i]) * r.invD[i];
+		if (t0 > t1) std::swap(t0, t1);
+		if (t0 > tNear)
+		{
+			tNear = t0;
+			entryAxis = i;
+		}
+		tFar = min(tFar, t1);
+	}
+	if (tFar < tNear)
+		return false;
+
+	return traverseNode(0, levels - 1, vec3<f32>(0.0f), tNear, tFar, entryAxis, r, t, normal, color);
+}
+
+vec3<f32> VoxelTree::childColor(const VoxelNode& node, u32 height, u32 offset) const
+{
+	if (height == 0)
+		return unpack_color(palette[voxels[node.childIndex + offset] - 1]);
+	return unpack_color(nodeColors[node.childIndex + offset]);
+}
+
+bool VoxelTree::traverseNode(u32 node, u32 height, const vec3<f32>& nodeMin, f32 tEnter, f32 tExit, int entryAxis,
+	const TraversalRay& r, f32& t, vec3<f32>& normal, vec3<f32>& color) const
+{
+	count_node();
+	const VoxelNode& voxelNode = nodes[node];
+
+	//mip level here, a child of this node is level 2 * height
+	u32 lod = r.minLod;
+	f32 footprint = r.coneWidth + r.coneSpread * tEnter;
+	if (footprint > 1.0f)
+		lod = max(lod, u32(log2f(footprint)));
+	//the cell the ray starts in is never a coarse hit, a bounce ray would hit its own surface at tMin
+	//with no entry face, the DDA runs over single children there and the start cell is refined
+	bool startsInside = tEnter <= r.tMin || entryAxis < 0;
+	bool half = lod > 2 * height && !startsInside;
+	bool solid = lod >= 2 * height;
+
+	//3D DDA over the 4x4x4 children, or over 2x2x2 groups of them
+	int n = half ? 2 : 4;
+	f32 cellSize = f32(1ull << (2 * height + (half ? 1 : 0)));
+	vec3<f32> p = r.o + r.d * tEnter;
+	int cell[3], step[3];
+	f32 tMax[3], tDelta[3];
+	for (int i = 0; i < 3; i++)
+	{
+		cell[i] = min(max(int(floorf((p[i] - nodeMin[i]) / cellSize)), 0), n - 1);
+		step[i] = r.d[i] >= 0.0f ? 1 : -1;
+		if (r.d[i] != 0.0f)
+		{
+			f32 boundary = nodeMin[i] + (cell[i] + (step[i] > 0 ? 1 : 0)) * cellSize;
+			tMax[i] = (boundary - r.o[i]) * r.invD[i];
+			tDelta[i] = cellSize * fabsf(r.invD[i]);
+		}
+		else
+		{
+			tMax[i] = F32_INF;
+			tDelta[i] = F32_INF;
+		}
+	}
+
+	f32 tCell = tEnter;
+	int axis = entryAxis;
+	while (true)
+	{
+		int a = (tMax[0] < tMax[1]) ? ((tMax[0] < tMax[2]) ? 0 : 2) : ((tMax[1] < tMax[2]) ? 1 : 2);
+		f32 tNext = min(tMax[a], tExit);
+
+		if (half)
+		{
+			u64 groupMask = voxelNode.childMask & GROUP_MASKS[cell[0] | (cell[1] << 1) | (cell[2] << 2)];
+			if (groupMask)
+			{
+				vec3<f32> sum;
+				for (u64 bits = groupMask; bits; bits &= bits - 1)
+				{
+					u64 lowest = bits & (~bits + 1);
+					sum += childColor(voxelNode, height, popcount64(voxelNode.childMask & (lowest - 1)));
+				}
+				t = tCell;
+				normal = vec3<f32>(0.0f);
+				if (axis >= 0)
+					normal[axis] = r.d[axis] > 0.0f ? -1.0f : 1.0f;
+				color = sum / f32(popcount64(groupMask));
+				return true;
+			}
+		}
+		else
+		{
+			u32 bit = cell[0] | (cell[1] << 2) | (cell[2] << 4);
+			if ((voxelNode.childMask >> bit) & 1)
+			{
+				u32 offset = popcount64(voxelNode.childMask & ((1ull << bit) - 1));
+				bool startCell = tCell <= r.tMin || axis < 0;
+				if (solid && !startCell)
+				{
+					t = tCell;
+					normal = vec3<f32>(0.0f);
+					if (axis >= 0)
+						normal[axis] = r.d[axis] > 0.0f ? -1.0f : 1.0f;
+					color = childColor(voxelNode, height, offset);
+					return true;
+				}
+
+				//a voxel the ray starts in is left, not hit
+				vec3<f32> childMin(nodeMin.x + cell[0] * cellSize, nodeMin.y + cell[1] * cellSize, nodeMin.z + cell[2] * cellSize);
+				if (height > 0 && traverseNode(voxelNode.childIndex + offset, height - 1, childMin, tCell, tNext, axis, r, t, normal, color))
+					return true;
+			}
+		}
+
+		if (tMax[a] >= tExit)
+			return false;
+
+		cell[a] += step[a];
+		if (cell[a] < 0 || cell[a] > n - 1)
+			return false;
+		tCell = tMax[a];
+		tMax[a] += tDelta[a];
+		axis = a;
+	}
+}
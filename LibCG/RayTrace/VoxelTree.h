@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include "../KDMath.h"
+
+struct Voxel
+{
+	u32 x;
+	u32 y;
+	u32 z;
+	u8 index;
+};
+
+/**
+* Sparse 64-tree node, each level splits 4x4x4.
+* Children are packed, the offset of a child is popcount of the lower mask bits.
+*/
+struct VoxelNode
+{
+	u64 childMask = 0;
+	//inner node: first child in nodes, brick: first voxel in voxels
+	u32 childIndex = 0;
+};
+
+/**
+* Two-level brickmap generalized to a sparse hierarchy of 4^3 bricks,
+* memory scales with occupied voxels and empty nodes are skipped in one DDA step.
+*/
+struct VoxelTree
+{
+	//world position of grid corner, one voxel = 1 unit
+	vec3<f32> origin;
+	//root covers 4^levels voxels per axis
+	u32 levels = 0;
+	std::vector<VoxelNode> nodes;
+	//palette index per occupied voxel
+	std::vector<u8> voxels;
+	//averaged color per node, same packing as palette
+	std::vector<u32> nodeColors;
+	u32 palette[256] = { 0 };
+
+	void build(std::vector<Voxel>& input);
+
+	/**
+	* @param minLod mip level to stop at, a level 1 cell covers 2x2x2 voxels.
+	* The level also grows with the ray cone footprint, so distant or wide rays stop early.
+	* Hits lie in (ray.tMin, ray.tMax] and have a face normal, the voxels around the ray origin are
+	* never coarsened and a voxel the ray starts inside is not hit.
+	*/
+	bool rayIntersect(const ray& ray, f32& t, vec3<f32>& normal, vec3<f32>& color, u32 minLod = 0) const;
+
+private:
+	struct TraversalRay;
+
+	void buildNode(u32 node, const std::vector<Voxel>& input, const std::vector<u64>& keys, size_t start, size_t end, u32 height);
+	bool traverseNode(u32 node, u32 height, const vec3<f32>& nodeMin, f32 tEnter, f32 tExit, int entryAxis,
+		const TraversalRay& r, f32& t, vec3<f32>& normal, vec3<f32>& color) const;
+	vec3<f32> childColor(const VoxelNode& node, u32 height, u32 offset) const;
+};
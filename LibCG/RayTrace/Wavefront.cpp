@@ -0,0 +1,219 @@
+#include "Wavefront.h"
+#include "../Util.h"
+
+#include <algorithm>
+
+using namespace RayTracer;
+
+static const u32 MATERIAL_TYPES = u32(MaterialType::Disney) + 1;
+
+void Wavefront::clear()
+{
+	pixelX.clear();
+	pixelY.clear();
+	sampleIndex.clear();
+}
+
+void Wavefront::add(i32 x, i32 y, u32 index)
+{
+	pixelX.push_back(x);
+	pixelY.push_back(y);
+	sampleIndex.push_back(index);
+}
+
+ray Wavefront::pathRay(u32 path) const
+{
+	ray ray;
+	ray.origin = origin[path];
+	ray.direction = direction[path];
+	ray.coneWidth = coneWidth[path];
+	ray.coneSpread = coneSpread[path];
+	return ray;
+}
+
+void Wavefront::trace(i32 width, i32 height, const Param& param, bool features)
+{
+	size_t count = size();
+	//resize keeps the capacity, batches of the same size allocate once per worker
+	sampler.resize(count);
+	origin.resize(count);
+	direction.resize(count);
+	coneWidth.resize(count);
+	coneSpread.resize(count);
+	throughput.resize(count);
+	attenuation.resize(count);
+	bsdfPdf.resize(count);
+	normal.resize(count);
+	radiance.resize(count);
+	hitInfo.resize(count);
+	result.assign(count, vec3<f32>(0.0f));
+	if (features)
+		primary.assign(count, PrimaryHit());
+	if constexpr (TRAVERSAL_STATS)
+		cost.assign(count, 0.0f);
+
+	generate(width, height, param);
+	for (int depth = 0; depth < maxDepth && !active.empty(); depth++)
+	{
+		extend();
+		miss();
+		shade(depth, param, features);
+		shadow();
+		accumulate();
+		active.swap(next);
+	}
+}
+
+void Wavefront::generate(i32 width, i32 height, const Param& param)
+{
+	active.resize(size());
+	for (u32 path = 0; path < size(); path++)
+	{
+		Sampler& s = sampler[path];
+		s.start(samplerType, pixelX[path], pixelY[path], width, sampleIndex[path]);
+		ray ray = camera_ray(pixelX[path], pixelY[path], width, height, param, s);
+		origin[path] = ray.origin;
+		direction[path] = ray.direction;
+		coneWidth[path] = ray.coneWidth;
+		coneSpread[path] = ray.coneSpread;
+		attenuation[path] = vec3<f32>(1.0f);
+		bsdfPdf[path] = 0.0f;
+		normal[path] = vec3<f32>(0.0f);
+		active[path] = path;
+	}
+}
+
+//closest hit of every active path, hits grouped by material type for the shade loop
+void Wavefront::extend()
+{
+	hits.clear();
+	misses.clear();
+	u32 typeCount[MATERIAL_TYPES] = { 0 };
+	for (u32 path : active)
+	{
+		throughput[path] = attenuation[path];
+		radiance[path] = vec3<f32>(0.0f);
+
+		HitInfo& hit = hitInfo[path];
+		hit = HitInfo();
+		TraversalStats before = traversal_stats();
+		closest_hit_intersect(pathRay(path), hit);
+		if constexpr (TRAVERSAL_STATS)
+			cost[path] += f32((traversal_stats() - before).work());
+		if (hit.t < F32_INF)
+		{
+			hits.push_back(path);
+			typeCount[u32(hit.material.type)]++;
+		}
+		else
+		{
+			misses.push_back(path);
+		}
+	}
+
+	u32 offset[MATERIAL_TYPES];
+	u32 sum = 0;
+	for (u32 type = 0; type < MATERIAL_TYPES; type++)
+	{
+		offset[type] = sum;
+		hitOffset[type] = sum;
+		sum += typeCount[type];
+	}
+	hitOffset[MATERIAL_TYPES] = sum;
+
+	//stable counting sort, skipped when one type covers the queue
+	if (*std::max_element(typeCount, typeCount + MATERIAL_TYPES) == hits.size())
+		return;
+	sorted.resize(hits.size());
+	for (u32 path : hits)
+		sorted[offset[u32(hitInfo[path].material.type)]++] = path;
+	hits.swap(sorted);
+}
+
+void Wavefront::miss()
+{
+	for (u32 path : misses)
+		radiance[path] = miss_radiance(pathRay(path), bsdfPdf[path]);
+}
+
+void Wavefront::shade(int depth, const Param& param, bool features)
+{
+	next.clear();
+	shadowPaths.clear();
+	shadowSamples.clear();
+
+	//the type switch runs once per batch instead of once per hit
+	const u32* h = hits.data();
+	shadeBatch<MaterialType::Lambert>(h + hitOffset[0], h + hitOffset[1], depth, param, features);
+	shadeBatch<MaterialType::Mirror>(h + hitOffset[1], h + hitOffset[2], depth, param, features);
+	shadeBatch<MaterialType::Glass>(h + hitOffset[2], h + hitOffset[3], depth, param, features);
+	shadeBatch<MaterialType::Disney>(h + hitOffset[3], h + hitOffset[4], depth, param, features);
+}
+
+template<MaterialType type>
+void Wavefront::shadeBatch(const u32* begin, const u32* end, int depth, const Param& param, bool features)
+{
+	bool lightSamples = !bsdf_is_delta<type>() && next_event_enabled(depth);
+
+	for (const u32* it = begin; it != end; ++it)
+	{
+		u32 path = *it;
+		const HitInfo& hit = hitInfo[path];
+		ray ray = pathRay(path);
+		vec3<f32> P = ray.origin + ray.direction * hit.t;
+		vec3<f32> wo = ray.direction * -1;
+		vec3<f32> ffnormal = faceforward(wo, hit.normal);
+		Sampler& s = sampler[path];
+		s.startBounce(depth);
+		count_bounce();
+
+		radiance[path] += emitted_radiance(ray, hit, bsdfPdf[path], normal[path]);
+
+		if (lightSamples)
+		{
+			LightSample lightSample;
+			if (sample_direct_light(P, ffnormal, s, lightSample))
+			{
+				lightSample.radiance *= light_sample_weight<type>(hit.material, wo, lightSample.shadowRay.direction, ffnormal, lightSample.pdf);
+				shadowPaths.push_back(path);
+				shadowSamples.push_back(lightSample);
+			}
+		}
+
+		if (depth == 0 && features)
+			record_primary_hit(ray, hit, param, primary[path]);
+
+		BsdfSample bsdf;
+		if (!sample_bsdf<type>(hit, wo, ffnormal, s, bsdf))
+			continue;
+		attenuation[path] *= bsdf.weight;
+		bsdfPdf[path] = bsdf.pdf;
+		normal[path] = ffnormal;
+		direction[path] = bsdf.wi;
+		origin[path] = P + faceforward(bsdf.wi, ffnormal) * 0.01f;
+		coneWidth[path] = ray.coneWidth + ray.coneSpread * hit.t;
+		coneSpread[path] = ray.coneSpread + voxelLodBounceSpread;
+
+		if (russian_roulette(attenuation[path], depth, s))
+			next.push_back(path);
+	}
+}
+
+void Wavefront::shadow()
+{
+	for (size_t i = 0; i < shadowPaths.size(); i++)
+	{
+		TraversalStats before = traversal_stats();
+		bool occluded = closest_hit_occlusion(shadowSamples[i].shadowRay);
+		if constexpr (TRAVERSAL_STATS)
+			cost[shadowPaths[i]] += f32((traversal_stats() - before).work());
+		if (!occluded)
+			radiance[shadowPaths[i]] += shadowSamples[i].radiance;
+	}
+}
+
+void Wavefront::accumulate()
+{
+	for (u32 path : active)
+		result[path] += throughput[path] * radiance[path];
+}
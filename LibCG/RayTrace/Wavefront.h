@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include "RayTracer.h"
+
+/**
+* Path tracer split into stages over a batch of camera samples instead of one path per call.
+* Each bounce runs extend (closest hit), miss, shade, shadow (occlusion of the light samples)
+* and accumulate as flat loops over queues of path indices, path state is kept as structure of arrays.
+* Hits are sorted by material type and shaded in one batch per type, each batch a loop over a single BSDF.
+* A path draws the same random numbers as ray_gen_sample, both integrators give the same image.
+*/
+struct Wavefront
+{
+	//radiance of each path in add order, filled by trace
+	std::vector<vec3<f32>> result;
+	//first hit of each path, only written when trace is asked for features
+	std::vector<RayTracer::PrimaryHit> primary;
+	//traversal work of each path, RAYTRACE_STATS builds only
+	std::vector<f32> cost;
+
+	void clear();
+
+	void add(i32 x, i32 y, u32 sampleIndex);
+
+	size_t size() const { return pixelX.size(); }
+
+	void trace(i32 width, i32 height, const RayTracer::Param& param, bool features);
+
+private:
+	//path state, one entry per added sample
+	std::vector<i32> pixelX;
+	std::vector<i32> pixelY;
+	std::vector<u32> sampleIndex;
+	std::vector<Sampler> sampler;
+	std::vector<vec3<f32>> origin;
+	std::vector<vec3<f32>> direction;
+	std::vector<f32> coneWidth;
+	std::vector<f32> coneSpread;
+	//weight of the vertex being shaded, and of the next one
+	std::vector<vec3<f32>> throughput;
+	std::vector<vec3<f32>> attenuation;
+	std::vector<f32> bsdfPdf;
+	std::vector<vec3<f32>> normal;
+	//radiance of the vertex being shaded
+	std::vector<vec3<f32>> radiance;
+	std::vector<HitInfo> hitInfo;
+
+	//path indices
+	std::vector<u32> active;
+	std::vector<u32> next;
+	std::vector<u32> hits;
+	std::vector<u32> misses;
+	std::vector<u32> sorted;
+	//hits of material type t are hits[hitOffset[t], hitOffset[t + 1])
+	u32 hitOffset[u32(MaterialType::Disney) + 2] = {};
+	std::vector<u32> shadowPaths;
+	std::vector<RayTracer::LightSample> shadowSamples;
+
+	ray pathRay(u32 path) const;
+
+	void generate(i32 width, i32 height, const RayTracer::Param& param);
+	void extend();
+	void miss();
+	void shade(int depth, const RayTracer::Param& param, bool features);
+	template<MaterialType type>
+	void shadeBatch(const u32* begin, const u32* end, int depth, const RayTracer::Param& param, bool features);
+	void shadow();
+	void accumulate();
+};
@@ -0,0 +1,284 @@
+#include "ThreadPool.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+	//pool and queue index of the calling thread, queue 0 for threads outside any pool
+	thread_local const ThreadPool* CURRENT_POOL = nullptr;
+	thread_local u32 CURRENT_QUEUE = 0;
+
+	std::mutex SHARED_POOL_MUTEX;
+	ThreadPool* SHARED_POOL = nullptr;
+	u32 SHARED_POOL_SIZE = 0;
+
+	//CPUs the process may run on, in index order
+	std::vector<u32> allowed_cpus()
+	{
+		std::vector<u32> cpus;
+#if defined(_WIN32)
+		DWORD_PTR processMask, systemMask;
+		if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+		{
+			for (u32 i = 0; i < sizeof(DWORD_PTR) * 8; i++)
+			{
+				if (processMask & (DWORD_PTR(1) << i))
+					cpus.push_back(i);
+			}
+		}
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) == 0)
+		{
+			for (u32 i = 0; i < CPU_SETSIZE; i++)
+			{
+				if (CPU_ISSET(i, &set))
+					cpus.push_back(i);
+			}
+		}
+#endif
+		return cpus;
+	}
+
+	void pin_current_thread(u32 cpu)
+	{
+#if defined(_WIN32)
+		SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu);
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+		(void)cpu;
+#endif
+	}
+
+#ifndef _WIN32
+	//only the forking thread exists in the child, the pool's workers and locks are the parent's
+	void forget_pool_in_child()
+	{
+		SHARED_POOL = nullptr;
+		new (&SHARED_POOL_MUTEX) std::mutex();
+	}
+#endif
+}
+
+ThreadPool::ThreadPool(u32 threadCount, bool pinThreads)
+{
+	if (threadCount == 0)
+		threadCount = max(1u, std::thread::hardware_concurrency());
+	queues.reset(new Queue[threadCount]);
+
+	//a pool smaller than the machine leaves placement to the OS, other processes may render next to it
+	std::vector<u32> cpus = pinThreads ? allowed_cpus() : std::vector<u32>();
+	bool pin = !cpus.empty() && threadCount >= cpus.size();
+
+	threads.reserve(threadCount - 1);
+	for (u32 i = 1; i < threadCount; i++)
+	{
+		u32 cpu = pin ? cpus[i % cpus.size()] : 0;
+		threads.emplace_back([this, i, pin, cpu]()
+			{
+				if (pin)
+					pin_current_thread(cpu);
+				workerLoop(i);
+			});
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stop = true;
+	}
+	wake.notify_all();
+	for (auto& thread : threads)
+		thread.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	Queue& queue = queues[CURRENT_POOL == this ? CURRENT_QUEUE : 0];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	queued.fetch_add(1);
+	//a worker checks queued under sleepMutex before it sleeps, taking it here can't lose the wake up
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wake.notify_one();
+}
+
+bool ThreadPool::pop(u32 self, std::function<void()>& task)
+{
+	if (queued.load() == 0)
+		return false;
+
+	u32 count = size();
+	//newest task of the own queue first, it shares the most data with the task that queued it
+	if (self != 0)
+	{
+		Queue& own = queues[self];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			queued.fetch_sub(1);
+			return true;
+		}
+	}
+
+	//oldest task of the others, the biggest piece of a recursive split
+	for (u32 i = 0; i < count; i++)
+	{
+		u32 victim = (self + i) % count;
+		if (victim == self && self != 0)
+			continue;
+		Queue& queue = queues[victim];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			queued.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ThreadPool::runPending()
+{
+	std::function<void()> task;
+	if (!pop(CURRENT_POOL == this ? CURRENT_QUEUE : 0, task))
+		return false;
+	task();
+	return true;
+}
+
+void ThreadPool::workerLoop(u32 index)
+{
+	CURRENT_POOL = this;
+	CURRENT_QUEUE = index;
+	while (true)
+	{
+		std::function<void()> task;
+		if (pop(index, task))
+		{
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [this]() { return stop || queued.load() > 0; });
+		if (stop && queued.load() == 0)
+			return;
+	}
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool)
+{
+}
+
+TaskGroup::TaskGroup() : pool(thread_pool())
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+	wait();
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+	pending.fetch_add(1);
+	pool.submit([this, task = std::move(task)]()
+		{
+			task();
+			pending.fetch_sub(1, std::memory_order_release);
+		});
+}
+
+void TaskGroup::wait()
+{
+	while (pending.load(std::memory_order_acquire) > 0)
+	{
+		//the last tasks are running elsewhere when there is nothing left to take
+		if (!pool.runPending())
+			std::this_thread::yield();
+	}
+}
+
+ThreadPool& thread_pool()
+{
+	std::lock_guard<std::mutex> lock(SHARED_POOL_MUTEX);
+	if (!SHARED_POOL)
+	{
+#ifndef _WIN32
+		static bool registered = false;
+		if (!registered)
+		{
+			pthread_atfork(nullptr, nullptr, forget_pool_in_child);
+			registered = true;
+		}
+#endif
+		SHARED_POOL = new ThreadPool(SHARED_POOL_SIZE);
+	}
+	return *SHARED_POOL;
+}
+
+void set_thread_pool_size(u32 threadCount)
+{
+	std::lock_guard<std::mutex> lock(SHARED_POOL_MUTEX);
+	SHARED_POOL_SIZE = threadCount;
+	if (SHARED_POOL && SHARED_POOL->size() != thread_pool_size())
+	{
+		delete SHARED_POOL;
+		SHARED_POOL = nullptr;
+	}
+}
+
+u32 thread_pool_size()
+{
+	return SHARED_POOL_SIZE == 0 ? max(1u, std::thread::hardware_concurrency()) : SHARED_POOL_SIZE;
+}
+
+void parallel_for(u32 count, u32 grain, const std::function<void(u32 begin, u32 end)>& func, u32 threadCount)
+{
+	if (count == 0)
+		return;
+	grain = max(grain, 1u);
+	u32 chunks = (count + grain - 1) / grain;
+	u32 participants = min(threadCount == 0 ? thread_pool_size() : threadCount, chunks);
+
+	std::atomic<u32> next{ 0 };
+	auto work = [&]()
+	{
+		for (u32 chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1))
+			func(chunk * grain, min(count, (chunk + 1) * grain));
+	};
+	if (participants <= 1)
+	{
+		work();
+		return;
+	}
+
+	TaskGroup group;
+	for (u32 i = 1; i < participants; i++)
+		group.run(work);
+	work();
+	group.wait();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "KDMath.h"
+
+/**
+* Work-stealing thread pool. Every worker owns a deque of tasks, takes its own newest task first and
+* steals the oldest one of another worker when it runs dry. Tasks submitted from outside the pool go
+* to a shared queue that every worker steals from. Threads waiting on their tasks run queued tasks
+* meanwhile, so nested parallel loops can't deadlock the pool.
+*/
+class ThreadPool
+{
+public:
+	/**
+	* @param threadCount threads working on a parallel loop, the waiting thread included, so
+	* threadCount - 1 workers are started. 0 = hardware concurrency
+	* @param pinThreads bind each worker to one CPU of the process affinity set
+	*/
+	explicit ThreadPool(u32 threadCount = 0, bool pinThreads = true);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//workers plus the thread waiting on them
+	u32 size() const { return u32(threads.size()) + 1; }
+
+	void submit(std::function<void()> task);
+
+	//run one queued task on the calling thread, false when there was none
+	bool runPending();
+
+private:
+	struct alignas(64) Queue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	//queue 0 takes tasks from threads outside the pool, worker i owns queue i
+	std::unique_ptr<Queue[]> queues;
+	std::vector<std::thread> threads;
+	std::atomic<u32> queued{ 0 };
+
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	bool stop = false;
+
+	bool pop(u32 self, std::function<void()>& task);
+	void workerLoop(u32 index);
+};
+
+/**
+* Tasks that are waited on together, the destructor waits too
+*/
+class TaskGroup
+{
+public:
+	explicit TaskGroup(ThreadPool& pool);
+	TaskGroup();
+	~TaskGroup();
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+	void run(std::function<void()> task);
+
+	//helps with queued tasks of the pool until the tasks of this group are done
+	void wait();
+
+private:
+	ThreadPool& pool;
+	std::atomic<u32> pending{ 0 };
+};
+
+/**
+* Pool shared by LibCG, created on first use with thread_pool_size() threads.
+* A forked child process gets a new pool, the workers of the parent don't exist in it.
+*/
+ThreadPool& thread_pool();
+
+/**
+* Threads of the shared pool, 0 = hardware concurrency. A running pool is rebuilt,
+* no parallel work may be in flight.
+*/
+void set_thread_pool_size(u32 threadCount);
+
+u32 thread_pool_size();
+
+/**
+* func(begin, end) over chunks of grain indices of [0, count), claimed by the calling thread
+* and at most threadCount - 1 workers of the shared pool in increasing order.
+* @param threadCount 0 = the whole pool
+*/
+void parallel_for(u32 count, u32 grain, const std::function<void(u32 begin, u32 end)>& func, u32 threadCount = 0);
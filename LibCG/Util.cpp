@@ -1,5 +1,19 @@
 #include "Util.h"
 
+#include <cstdio>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 Profiler::Profiler(std::string name) : name(name)
 {
 	start = std::chrono::steady_clock::now();
@@ -12,6 +26,108 @@ Profiler::~Profiler()
 	printf("[Profiler] (%s) cost %f seconds.\n", name.c_str(), elapsed_seconds.count());
 }
 
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const char* filename)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+	size = (size_t)fileSize.QuadPart;
+
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle)
+	{
+		close();
+		return false;
+	}
+	data = (const u8*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+	fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close();
+		return false;
+	}
+	size = (size_t)st.st_size;
+
+	void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (ptr != MAP_FAILED)
+	{
+		madvise(ptr, size, MADV_SEQUENTIAL);
+		data = (const u8*)ptr;
+	}
+#endif
+	if (!data)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (data) UnmapViewOfFile(data);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle) CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (data) munmap((void*)data, size);
+	if (fd >= 0) ::close(fd);
+	fd = -1;
+#endif
+	data = nullptr;
+	size = 0;
+}
+
+bool write_file_atomic(const char* filename, const std::vector<FileChunk>& chunks)
+{
+	std::string tmp = std::string(filename) + ".tmp";
+	FILE* file = fopen(tmp.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool ok = true;
+	for (const FileChunk& chunk : chunks)
+		ok = ok && (chunk.size == 0 || fwrite(chunk.data, chunk.size, 1, file) == 1);
+	ok = ok && fflush(file) == 0;
+#ifdef _WIN32
+	ok = ok && FlushFileBuffers((HANDLE)_get_osfhandle(_fileno(file)));
+#else
+	ok = ok && fsync(fileno(file)) == 0;
+#endif
+	ok = fclose(file) == 0 && ok;
+
+#ifdef _WIN32
+	ok = ok && MoveFileExA(tmp.c_str(), filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	ok = ok && rename(tmp.c_str(), filename) == 0;
+#endif
+	if (!ok)
+		remove(tmp.c_str());
+	return ok;
+}
+
 vec3<f32> tangent_to_world(const vec3<f32>& dir, const vec3<f32>& normal)
 {
 	f32 sign = normal.z >= 0.0f ? 1.0f : -1.0f;
@@ -1,6 +1,8 @@
 ﻿#pragma once
 
 #include <chrono>
+#include <string>
+#include <vector>
 #include "KDMath.h"
 
 struct Profiler
@@ -11,6 +13,43 @@ struct Profiler
 	std::chrono::steady_clock::time_point start;
 };
 
+/**
+* Read-only memory mapped file
+*/
+struct MappedFile
+{
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	bool open(const char* filename);
+	void close();
+
+	const u8* data = nullptr;
+	size_t size = 0;
+
+private:
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fd = -1;
+#endif
+};
+
+struct FileChunk
+{
+	const void* data;
+	size_t size;
+};
+
+/**
+* Write the chunks to filename.tmp, flush it to disk and rename it over filename.
+* A crash leaves either the old file or the new one, never a partial write.
+*/
+bool write_file_atomic(const char* filename, const std::vector<FileChunk>& chunks);
+
 inline u32 rgb2hex(i32 r, i32 g, i32 b)
 {
 	return (r << 16) | (g << 8) | b;
@@ -40,6 +79,11 @@ inline vec4<f32> hex2rgba(u32 color)
 	return vec4<f32>(r, g, b, a);
 }
 
+inline f32 luminance(const vec3<f32>& color)
+{
+	return 0.2126f * color.x + 0.7152f * color.y + 0.0722f * color.z;
+}
+
 /**
 * Mersenne Twister algorithm
 */
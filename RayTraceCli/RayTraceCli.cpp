@@ -0,0 +1,427 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stb_image_write.h>
+#include <RayTrace/RayTracer.h>
+#include <RayTrace/TileScheduler.h>
+#include <RayTrace/Distributed.h>
+#include <ThreadPool.h>
+
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+using namespace RayTracer;
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+	const char* scene = nullptr;
+	//.hdr environment light, the sky gradient without one
+	const char* environment = nullptr;
+	const char* output = "out.png";
+	i32 width = 800;
+	i32 height = 600;
+	int spp = 64;
+	int depth = 4;
+	u32 threads = 0;
+	vec3<f32> position{ 0.0f, 0.5f, 2.0f };
+	vec3<f32> target{ 0.0f, 0.5f, 0.0f };
+	f32 fov = 45.0f;
+	bool voxTree = false;
+	bool wavefront = false;
+	SamplerType sampler = SamplerType::Sobol;
+	bool denoise = false;
+	bool progress = false;
+	//write the traversal cost heatmap instead of the image
+	bool cost = false;
+	//local worker processes, 0 renders in this process
+	u32 workers = 0;
+	//serve a coordinator on stdin/stdout instead of rendering
+	bool worker = false;
+	//progressive render saved to and resumed from this file
+	const char* checkpoint = nullptr;
+	f32 checkpointSeconds = 300.0f;
+};
+
+static void print_usage()
+{
+	printf("usage: RayTraceCli <scene.obj|scene.vox> [options]\n"
+		"  -o <file.png>            output image, default out.png\n"
+		"  -size <width> <height>   resolution, default 800 600\n"
+		"  -spp <n>                 samples per pixel, default 64\n"
+		"  -depth <n>               max path depth, default 4\n"
+		"  -threads <n>             render threads of each process, default 0 = all cores\n"
+		"  -camera <x y z> <x y z>  position and look-at target, default 0 0.5 2  0 0.5 0\n"
+		"  -fov <degrees>           vertical field of view, default 45\n"
+		"  -env <file.hdr>          equirectangular environment light, +y up\n"
+		"  -voxtree                 load .vox into a sparse voxel tree instead of boxes\n"
+		"  -wavefront               wavefront integrator\n"
+		"  -sampler <name>          sobol, bluenoise or random, default sobol\n"
+		"  -denoise                 filter the image before writing it\n"
+		"  -progress                print progress to stderr\n"
+		"  -cost                    write the traversal cost heatmap, needs a STATS=1 build\n"
+		"  -workers <n>             split the frame over n worker processes\n"
+		"  -worker                  render regions for a coordinator on stdin/stdout\n"
+		"  -checkpoint <file>       save progress to file, resume from it when it exists\n"
+		"  -checkpoint-seconds <s>  time between checkpoints, default 300\n");
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+	auto need = [&](int i, int count) { return i + count < argc; };
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		if (arg[0] != '-')
+		{
+			if (options.scene)
+				return false;
+			options.scene = arg;
+		}
+		else if (!strcmp(arg, "-o") && need(i, 1))
+		{
+			options.output = argv[++i];
+		}
+		else if (!strcmp(arg, "-size") && need(i, 2))
+		{
+			options.width = atoi(argv[++i]);
+			options.height = atoi(argv[++i]);
+		}
+		else if (!strcmp(arg, "-spp") && need(i, 1))
+		{
+			options.spp = atoi(argv[++i]);
+		}
+		else if (!strcmp(arg, "-depth") && need(i, 1))
+		{
+			options.depth = atoi(argv[++i]);
+		}
+		else if (!strcmp(arg, "-threads") && need(i, 1))
+		{
+			options.threads = (u32)atoi(argv[++i]);
+		}
+		else if (!strcmp(arg, "-camera") && need(i, 6))
+		{
+			for (int k = 0; k < 3; k++)
+				options.position[k] = (f32)atof(argv[++i]);
+			for (int k = 0; k < 3; k++)
+				options.target[k] = (f32)atof(argv[++i]);
+		}
+		else if (!strcmp(arg, "-fov") && need(i, 1))
+		{
+			options.fov = (f32)atof(argv[++i]);
+		}
+		else if (!strcmp(arg, "-env") && need(i, 1))
+		{
+			options.environment = argv[++i];
+		}
+		else if (!strcmp(arg, "-voxtree"))
+		{
+			options.voxTree = true;
+		}
+		else if (!strcmp(arg, "-wavefront"))
+		{
+			options.wavefront = true;
+		}
+		else if (!strcmp(arg, "-sampler") && need(i, 1))
+		{
+			const char* name = argv[++i];
+			if (!strcmp(name, "sobol"))
+				options.sampler = SamplerType::Sobol;
+			else if (!strcmp(name, "bluenoise"))
+				options.sampler = SamplerType::BlueNoise;
+			else if (!strcmp(name, "random"))
+				options.sampler = SamplerType::Random;
+			else
+				return false;
+		}
+		else if (!strcmp(arg, "-denoise"))
+		{
+			options.denoise = true;
+		}
+		else if (!strcmp(arg, "-progress"))
+		{
+			options.progress = true;
+		}
+		else if (!strcmp(arg, "-cost"))
+		{
+			options.cost = true;
+		}
+		else if (!strcmp(arg, "-workers") && need(i, 1))
+		{
+			options.workers = (u32)atoi(argv[++i]);
+		}
+		else if (!strcmp(arg, "-worker"))
+		{
+			options.worker = true;
+		}
+		else if (!strcmp(arg, "-checkpoint") && need(i, 1))
+		{
+			options.checkpoint = argv[++i];
+		}
+		else if (!strcmp(arg, "-checkpoint-seconds") && need(i, 1))
+		{
+			options.checkpointSeconds = (f32)atof(argv[++i]);
+		}
+		else
+		{
+			return false;
+		}
+	}
+	//worker regions are one-shot renders, there is no accumulation to save
+	if (options.checkpoint && (options.workers > 0 || options.worker))
+		return false;
+	return options.scene && options.width > 0 && options.height > 0 && options.spp > 0 && options.depth > 0;
+}
+
+static bool ends_with(const std::string& s, const char* suffix)
+{
+	size_t n = strlen(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool load_scene(const Options& options)
+{
+	std::string path = options.scene;
+	for (auto& c : path)
+		c = (char)tolower(c);
+
+	if (ends_with(path, ".obj"))
+		return bvhScene.loadFormObj(options.scene);
+	if (ends_with(path, ".vox"))
+		return options.voxTree ? bvhScene.loadFormVoxTree(options.scene) : bvhScene.loadFormVox(options.scene);
+
+	fprintf(stderr, "[Scene] unknown format %s\n", options.scene);
+	return false;
+}
+
+//render output is bottom-up 0x00RRGGBB, PNG is top-down rgb
+static bool write_png(const char* filename, const u32* pixels, i32 width, i32 height)
+{
+	std::vector<u8> rgb(size_t(width) * height * 3);
+	for (i32 y = 0; y < height; y++)
+	{
+		const u32* row = pixels + size_t(height - 1 - y) * width;
+		u8* out = rgb.data() + size_t(y) * width * 3;
+		for (i32 x = 0; x < width; x++)
+		{
+			out[x * 3] = (row[x] >> 16) & 0xff;
+			out[x * 3 + 1] = (row[x] >> 8) & 0xff;
+			out[x * 3 + 2] = row[x] & 0xff;
+		}
+	}
+	return stbi_write_png(filename, width, height, 3, rgb.data(), width * 3) != 0;
+}
+
+#ifndef _WIN32
+struct WorkerProcess
+{
+	pid_t pid;
+	FdChannel* channel;
+};
+
+//forked after the scene is built, workers share its pages copy-on-write and never write them
+static std::vector<WorkerProcess> spawn_workers(u32 count, u32 threads)
+{
+	std::vector<WorkerProcess> workers;
+	//a worker that died must fail the write, not kill the coordinator
+	signal(SIGPIPE, SIG_IGN);
+	fflush(stdout);
+	fflush(stderr);
+	for (u32 w = 0; w < count; w++)
+	{
+		int request[2], reply[2];
+		if (pipe(request) != 0)
+			break;
+		if (pipe(reply) != 0)
+		{
+			close(request[0]);
+			close(request[1]);
+			break;
+		}
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			//keep only this worker's ends
+			for (auto& other : workers)
+				delete other.channel;
+			close(request[1]);
+			close(reply[0]);
+			threadCount = threads;
+			set_thread_pool_size(threads);
+			renderProgressCallback = nullptr;
+			FdChannel channel(request[0], reply[1]);
+			_exit(serve_render_worker(channel) ? 0 : 1);
+		}
+		close(request[0]);
+		close(reply[1]);
+		if (pid < 0)
+		{
+			close(request[1]);
+			close(reply[0]);
+			break;
+		}
+		workers.push_back(WorkerProcess{ pid, new FdChannel(reply[0], request[1]) });
+	}
+	return workers;
+}
+
+static void join_workers(std::vector<WorkerProcess>& workers)
+{
+	std::vector<RenderChannel*> channels;
+	for (auto& worker : workers)
+		channels.push_back(worker.channel);
+	stop_render_workers(channels);
+	for (auto& worker : workers)
+	{
+		delete worker.channel;
+		waitpid(worker.pid, nullptr, 0);
+	}
+	workers.clear();
+}
+#endif
+
+static f64 seconds_since(Clock::time_point start)
+{
+	return std::chrono::duration<f64>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!parse_options(argc, argv, options))
+	{
+		print_usage();
+		return 1;
+	}
+
+	//stdout carries the protocol in worker mode
+	FILE* log = options.worker ? stderr : stdout;
+
+	//loaders and the BVH build use the shared pool too
+	set_thread_pool_size(options.threads);
+
+	Clock::time_point loadStart = Clock::now();
+	if (!load_scene(options))
+	{
+		fprintf(stderr, "[Scene] failed to load %s\n", options.scene);
+		return 1;
+	}
+	if (options.environment && !environmentMap.load(options.environment))
+		return 1;
+	f64 loadSeconds = seconds_since(loadStart);
+
+	Clock::time_point buildStart = Clock::now();
+	bvhScene.build();
+	f64 buildSeconds = seconds_since(buildStart);
+	fprintf(log, "[Scene] %s: %zu primitives, %zu lights, load %.3f s, build %.3f s\n", options.scene,
+		bvhScene.primitives.size(), bvhScene.lightList.lights.size(), loadSeconds, buildSeconds);
+
+	threadCount = options.threads;
+	if (options.worker)
+	{
+#ifndef _WIN32
+		FdChannel channel(STDIN_FILENO, STDOUT_FILENO);
+		return serve_render_worker(channel) ? 0 : 1;
+#else
+		fprintf(stderr, "[Distributed] -worker needs POSIX pipes\n");
+		return 1;
+#endif
+	}
+
+	camera.setFovYAndAspect(options.fov, (f32)options.width / (f32)options.height);
+	camera.setPositon(options.position.x, options.position.y, options.position.z);
+	camera.lookAt(options.target);
+
+	samplesPerPixel = options.spp;
+	maxDepth = options.depth;
+	samplerType = options.sampler;
+	integrator = options.wavefront ? Integrator::Wavefront : Integrator::Megakernel;
+	denoiseOutput = options.denoise;
+	if (options.cost)
+	{
+		if (!TRAVERSAL_STATS)
+			fprintf(stderr, "[Render] built without RAYTRACE_STATS, the cost heatmap is black\n");
+		renderOutput = RenderOutput::Cost;
+	}
+	if (options.progress)
+	{
+		renderProgressCallback = [](float progress)
+		{
+			fprintf(stderr, "\r[Render] %5.1f %%", progress);
+			if (progress >= 100.0f)
+				fprintf(stderr, "\n");
+		};
+	}
+
+	//workers split the machine unless -threads says otherwise
+	u32 workerThreads = options.threads > 0 ? options.threads : max(1u, tile_worker_count() / max(options.workers, 1u));
+	u32 renderThreads = tile_worker_count(options.threads);
+
+	std::vector<u32> image(size_t(options.width) * options.height);
+	Clock::time_point renderStart = Clock::now();
+#ifndef _WIN32
+	std::vector<WorkerProcess> workers;
+	if (options.workers > 0)
+		workers = spawn_workers(options.workers, workerThreads);
+	if (!workers.empty())
+	{
+		std::vector<RenderChannel*> channels;
+		for (auto& worker : workers)
+			channels.push_back(worker.channel);
+		bool rendered = render_distributed(options.width, options.height, image.data(), channels);
+		join_workers(workers);
+		if (!rendered)
+			return 1;
+		renderThreads = u32(channels.size()) * workerThreads;
+	}
+	else
+#else
+	if (options.workers > 0)
+		fprintf(stderr, "[Distributed] worker processes need fork, rendering in this process\n");
+#endif
+	if (options.checkpoint)
+	{
+		//passes of a few samples, each may be the last one saved
+		progressive = true;
+		samplesPerFrame = max(1, options.spp / 64);
+		checkpointFile = options.checkpoint;
+		checkpointSeconds = options.checkpointSeconds;
+		if (load_checkpoint(options.checkpoint))
+			printf("[Checkpoint] resumed %s at %d spp\n", options.checkpoint, accumulated_samples());
+		render_until(options.width, options.height, image.data(), Clock::now() + std::chrono::hours(24 * 365));
+	}
+	else
+	{
+		render(options.width, options.height, image.data());
+	}
+	f64 renderSeconds = seconds_since(renderStart);
+
+	const RenderStats& stats = renderStats;
+	printf("[Render] %dx%d, %d spp, depth %d, %u threads, %s: %.3f s\n", options.width, options.height, options.spp,
+		options.depth, renderThreads, options.wavefront ? "wavefront" : "megakernel", renderSeconds);
+	printf("[Render] %llu samples, %llu rays, %.2f Mrays/s\n", (unsigned long long)stats.samples, (unsigned long long)stats.rays,
+		renderSeconds > 0.0 ? stats.rays / renderSeconds * 1e-6 : 0.0);
+	if (TRAVERSAL_STATS && stats.rays > 0 && stats.samples > 0)
+	{
+		const TraversalStats& traversal = stats.traversal;
+		printf("[Render] %llu nodes, %llu primitive tests, %llu bounces: %.1f nodes/ray, %.1f tests/ray, %.2f bounces/path, %.2f Mnodes/s\n",
+			(unsigned long long)traversal.nodes, (unsigned long long)traversal.primitives, (unsigned long long)traversal.bounces,
+			f64(traversal.nodes) / stats.rays, f64(traversal.primitives) / stats.rays, f64(traversal.bounces) / stats.samples,
+			renderSeconds > 0.0 ? traversal.nodes / renderSeconds * 1e-6 : 0.0);
+	}
+
+	if (!write_png(options.output, image.data(), options.width, options.height))
+	{
+		fprintf(stderr, "[Output] failed to write %s\n", options.output);
+		return 1;
+	}
+	printf("[Output] %s\n", options.output);
+	return 0;
+}
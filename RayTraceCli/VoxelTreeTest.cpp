@@ -0,0 +1,74 @@
+//make test: checks of VoxelTree traversal, exits non-zero on a failure
+#include <cstdio>
+#include <RayTrace/VoxelTree.h>
+
+static int failures = 0;
+
+#define CHECK(condition, ...) \
+	do { if (!(condition)) { printf("[VoxelTreeTest] %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+//64 x 64 floor one voxel thick, top face at y = 1
+static void build_floor(VoxelTree& tree)
+{
+	std::vector<Voxel> voxels;
+	for (u32 z = 0; z < 64; z++)
+	{
+		for (u32 x = 0; x < 64; x++)
+			voxels.push_back({ x, 0, z, 1 });
+	}
+	tree.palette[0] = 0xff808080;
+	tree.build(voxels);
+}
+
+static ray make_ray(const vec3<f32>& origin, const vec3<f32>& direction, f32 coneWidth)
+{
+	ray r;
+	r.origin = origin;
+	r.direction = normalize(direction);
+	r.coneWidth = coneWidth;
+	return r;
+}
+
+int main()
+{
+	VoxelTree tree;
+	build_floor(tree);
+
+	const f32 coneWidths[] = { 0.0f, 1.0f, 2.5f, 5.0f, 9.0f, 40.0f };
+	for (f32 coneWidth : coneWidths)
+	{
+		f32 t;
+		vec3<f32> normal, color;
+
+		//bounce leaving the floor, wide cones must not hit the floor it starts on
+		ray up = make_ray(vec3<f32>(20.5f, 1.01f, 20.5f), vec3<f32>(0.0f, 1.0f, 0.0f), coneWidth);
+		CHECK(!tree.rayIntersect(up, t, normal, color), "cone %g: upward bounce hit t=%g n=%g %g %g", coneWidth, t, normal.x, normal.y, normal.z);
+
+		ray grazing = make_ray(vec3<f32>(20.5f, 1.01f, 20.5f), vec3<f32>(1.0f, 0.2f, 0.3f), coneWidth);
+		if (tree.rayIntersect(grazing, t, normal, color))
+			CHECK(t > grazing.tMin && dot(normal, normal) == 1.0f, "cone %g: grazing bounce hit t=%g n=%g %g %g", coneWidth, t, normal.x, normal.y, normal.z);
+
+		//from above, the hit is in front of the origin and has a face normal
+		ray down = make_ray(vec3<f32>(30.5f, 50.0f, 30.5f), vec3<f32>(0.0f, -1.0f, 0.0f), coneWidth);
+		bool hit = tree.rayIntersect(down, t, normal, color);
+		CHECK(hit, "cone %g: downward ray missed", coneWidth);
+		if (hit)
+			CHECK(t > 0.0f && t <= 49.0f && normal.y == 1.0f, "cone %g: downward hit t=%g n=%g %g %g", coneWidth, t, normal.x, normal.y, normal.z);
+
+		//the ray interval bounds the hit
+		down.tMax = 10.0f;
+		CHECK(!tree.rayIntersect(down, t, normal, color), "cone %g: hit beyond tMax at t=%g", coneWidth, t);
+		down.tMax = F32_INF;
+		down.tMin = 60.0f;
+		CHECK(!tree.rayIntersect(down, t, normal, color), "cone %g: hit before tMin at t=%g", coneWidth, t);
+	}
+
+	//without a cone the hit is exact
+	f32 t;
+	vec3<f32> normal, color;
+	ray down = make_ray(vec3<f32>(30.5f, 50.0f, 30.5f), vec3<f32>(0.0f, -1.0f, 0.0f), 0.0f);
+	CHECK(tree.rayIntersect(down, t, normal, color) && t == 49.0f, "exact hit at t=%g", t);
+
+	printf("[VoxelTreeTest] %s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
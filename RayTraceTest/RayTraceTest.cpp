@@ -20,10 +20,18 @@ void onStart()
 
 	bvhScene.loadFormObj("../Assets/bunny.obj");
 	//bvhScene.loadFormVox("../Assets/chr_sword.vox");
+	//bvhScene.loadFormVoxTree("../Assets/chr_sword.vox");
 	bvhScene.build();
 	//bvhScene.mode = BVHAccelMode::None;
 	//RayTracer::samplesPerPixel = 16;
 
+	//first image after one sample, refined on following paints
+	progressive = true;
+	samplesPerFrame = 1;
+
+	//every plane in the same pass, switching the output keeps the accumulation
+	aovMask = (1u << u32(Aov::Count)) - 1;
+
 	//renderProgressCallback = [](float progress)
 	//{
 	//	printf("[Render Progress] %.1f %%\n", progress);
@@ -37,7 +45,8 @@ void onRender()
 	for (int i = 0; i < WIDTH * HEIGHT; ++i)
 		*pixel++ = 0xffffff;
 
-	render(WIDTH, HEIGHT, OUTPUT_IMAGE);
+	//refine within a frame budget so the window stays responsive
+	render_until(WIDTH, HEIGHT, OUTPUT_IMAGE, std::chrono::steady_clock::now() + std::chrono::milliseconds(50));
 }
 
 void onKeyDown(HWND hWnd, WPARAM wParam, bool charcode)
@@ -106,6 +115,55 @@ void onKeyDown(HWND hWnd, WPARAM wParam, bool charcode)
 			InvalidateRect(hWnd, nullptr, false);
 			break;
 		}
+		case '5':
+		{
+			renderOutput = RenderOutput::Depth;
+			InvalidateRect(hWnd, nullptr, false);
+			break;
+		}
+		case '6':
+		{
+			renderOutput = RenderOutput::PrimitiveId;
+			InvalidateRect(hWnd, nullptr, false);
+			break;
+		}
+		case '7':
+		{
+			renderOutput = RenderOutput::SampleCount;
+			InvalidateRect(hWnd, nullptr, false);
+			break;
+		}
+		case '8':
+		{
+			//black unless built with RAYTRACE_STATS
+			renderOutput = RenderOutput::Cost;
+			InvalidateRect(hWnd, nullptr, false);
+			break;
+		}
+		case 'i':
+		{
+			//same image either way, only the speed differs
+			integrator = integrator == Integrator::Megakernel ? Integrator::Wavefront : Integrator::Megakernel;
+			printf("Integrator %s\n", integrator == Integrator::Wavefront ? "wavefront" : "megakernel");
+			InvalidateRect(hWnd, nullptr, false);
+			break;
+		}
+		case 'o':
+		{
+			//sobol -> blue noise -> random
+			const char* names[] = { "random", "sobol", "bluenoise" };
+			samplerType = SamplerType((u32(samplerType) + 1) % 3);
+			printf("Sampler %s\n", names[u32(samplerType)]);
+			InvalidateRect(hWnd, nullptr, false);
+			break;
+		}
+		case 'n':
+		{
+			denoiseOutput = !denoiseOutput;
+			printf("Denoise %s\n", denoiseOutput ? "on" : "off");
+			InvalidateRect(hWnd, nullptr, false);
+			break;
+		}
 		case 'w':
 		{
 			camera.moveFoward(0.5f);
@@ -187,6 +245,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			OUTPUT_IMAGE, &bitmap_info, DIB_RGB_COLORS, SRCCOPY);
 
 		EndPaint(hWnd, &ps);
+
+		if (progressive && !accumulation_done())
+			InvalidateRect(hWnd, nullptr, false);
 		break;
 	}
 	case WM_DESTROY:
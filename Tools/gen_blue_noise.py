@@ -0,0 +1,79 @@
+"""Generate LibCG/RayTrace/BlueNoise.cpp, a toroidal blue-noise rank tile made with void and cluster (Ulichney 1993).
+
+    python3 Tools/gen_blue_noise.py > LibCG/RayTrace/BlueNoise.cpp
+"""
+import math
+import random
+
+SIZE = 64
+SIGMA = 1.5
+RADIUS = 6
+N = SIZE * SIZE
+
+KERNEL = [(dx, dy, math.exp(-(dx * dx + dy * dy) / (2 * SIGMA * SIGMA)))
+          for dy in range(-RADIUS, RADIUS + 1) for dx in range(-RADIUS, RADIUS + 1)]
+
+
+def splat(energy, p, sign):
+    x, y = p % SIZE, p // SIZE
+    for dx, dy, w in KERNEL:
+        energy[(x + dx) % SIZE + (y + dy) % SIZE * SIZE] += sign * w
+
+
+def tightest_cluster(energy, pattern):
+    return max((p for p in range(N) if pattern[p]), key=lambda p: energy[p])
+
+
+def largest_void(energy, pattern):
+    return min((p for p in range(N) if not pattern[p]), key=lambda p: energy[p])
+
+
+def main():
+    rng = random.Random(1)
+    ones = N // 10
+    pattern = [False] * N
+    energy = [0.0] * N
+    for p in rng.sample(range(N), ones):
+        pattern[p] = True
+        splat(energy, p, 1)
+
+    # initial binary pattern, move the tightest cluster into the largest void until stable
+    while True:
+        cluster = tightest_cluster(energy, pattern)
+        pattern[cluster] = False
+        splat(energy, cluster, -1)
+        void = largest_void(energy, pattern)
+        if void == cluster:
+            pattern[cluster] = True
+            splat(energy, cluster, 1)
+            break
+        pattern[void] = True
+        splat(energy, void, 1)
+
+    rank = [0] * N
+    # phase 1, ranks below the initial pattern by removing clusters
+    phase = pattern[:]
+    phaseEnergy = energy[:]
+    for r in range(ones - 1, -1, -1):
+        cluster = tightest_cluster(phaseEnergy, phase)
+        phase[cluster] = False
+        splat(phaseEnergy, cluster, -1)
+        rank[cluster] = r
+    # phases 2 and 3, filling the largest void is filling the tightest cluster of zeros
+    for r in range(ones, N):
+        void = largest_void(energy, pattern)
+        pattern[void] = True
+        splat(energy, void, 1)
+        rank[void] = r
+
+    print("#include \"BlueNoise.h\"")
+    print()
+    print("//generated by Tools/gen_blue_noise.py, void and cluster %dx%d, sigma %.1f" % (SIZE, SIZE, SIGMA))
+    print("const u16 BLUE_NOISE_TILE[BLUE_NOISE_SIZE * BLUE_NOISE_SIZE] =")
+    print("{")
+    for y in range(SIZE):
+        print("\t" + ", ".join(str(v) for v in rank[y * SIZE:(y + 1) * SIZE]) + ",")
+    print("};")
+
+
+main()